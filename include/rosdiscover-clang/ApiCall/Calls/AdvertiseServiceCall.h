@@ -2,6 +2,7 @@
 
 #include <tuple>
 
+#include "../../Helper/Log.h"
 #include "../../Helper/FormatHelper.h"
 #include "../../Callback/Callback.h"
 #include "../RosApiCall.h"
@@ -63,31 +64,31 @@ public:
 private:
   // std::tuple<clang::TemplateArgument const &, clang::TemplateArgument const &> const getRequestResponseTemplateArgs() const {
   std::tuple<clang::CXXRecordDecl const *, clang::CXXRecordDecl const *> const getRequestResponseTypeDecls() const {
-    llvm::outs() << "obtaining template arguments for API call: \n";
-    print(llvm::outs());
-    llvm::outs() << "\n";
+    Log::outs() << "obtaining template arguments for API call: \n";
+    print(Log::outs());
+    Log::outs() << "\n";
 
     auto const *templateArgs = getCallExpr()->getDirectCallee()->getTemplateSpecializationArgs();
 
     if (templateArgs == nullptr) {
-      llvm::errs() << "FATAL ERROR: unable to obtain template arguments for NodeHandle::advertiseService call\n";
-      getCallExpr()->dumpColor();
-      llvm::errs() << "\n";
+      Log::errs() << "FATAL ERROR: unable to obtain template arguments for NodeHandle::advertiseService call\n";
+      getCallExpr()->printPretty(Log::errs(), nullptr, clang::PrintingPolicy(clang::LangOptions()));
+      Log::errs() << "\n";
       abort();
     }
 
     auto numTemplateArgs = templateArgs->size();
 
-    llvm::outs() << "DEBUG: template args [" << numTemplateArgs << "]:\n";
+    Log::outs() << "DEBUG: template args [" << numTemplateArgs << "]:\n";
     for (auto const &arg : templateArgs->asArray()) {
-      llvm::outs() << " * ";
-      arg.dump();
-      llvm::outs() << "\n";
+      Log::outs() << " * ";
+      arg.dump(Log::outs());
+      Log::outs() << "\n";
     }
 
     if (numTemplateArgs == 0) {
       // FIXME https://docs.ros.org/en/api/roscpp/html/classros_1_1NodeHandle.html#ae659319707eb40e8ef302763f7d632da
-      llvm::errs() << "FATAL ERROR: unable to obtain format for NodeHandle::advertiseService(AdvertiseServiceOptions &ops)\n";
+      Log::errs() << "FATAL ERROR: unable to obtain format for NodeHandle::advertiseService(AdvertiseServiceOptions &ops)\n";
       abort();
     } else if (numTemplateArgs == 3) {
       auto *request = getTypeDeclFromTemplateArgument(templateArgs->get(1));
@@ -98,7 +99,7 @@ private:
       auto *response = getTypeDeclFromTemplateArgument(templateArgs->get(1));
       return std::make_tuple(request, response);
     } else {
-      llvm::errs()
+      Log::errs()
         << "FATAL ERROR: unexpected number of template args for NodeHandle::advertiseService: "
         << numTemplateArgs
         << "\n";
@@ -109,13 +110,13 @@ private:
   std::tuple<std::string, std::string> getRequestResponseTypeNames() const {
     auto typeDecls = getRequestResponseTypeDecls();
 
-    llvm::outs() << "DEBUG: Found request type decl: ";
-    std::get<0>(typeDecls)->dump();
-    llvm::outs() << "\n";
+    Log::outs() << "DEBUG: Found request type decl: ";
+    std::get<0>(typeDecls)->dump(Log::outs());
+    Log::outs() << "\n";
 
-    llvm::outs() << "DEBUG: Found response type decl: ";
-    std::get<1>(typeDecls)->dump();
-    llvm::outs() << "\n";
+    Log::outs() << "DEBUG: Found response type decl: ";
+    std::get<1>(typeDecls)->dump(Log::outs());
+    Log::outs() << "\n";
 
     return std::make_tuple(
       std::get<0>(typeDecls)->getQualifiedNameAsString(),
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../../Helper/Log.h"
 #include "../RosApiCall.h"
 #include "../../Helper/CallOrConstructExpr.h"
 
@@ -61,7 +62,7 @@ public:
 
 private:
   clang::TemplateArgument const getFormatTemplateArg() const {
-    llvm::outs() << "DEBUG: fetching format template argument for message_filters::Subscriber call\n";
+    Log::outs() << "DEBUG: fetching format template argument for message_filters::Subscriber call\n";
     auto *recordDecl = clang::dyn_cast<clang::ClassTemplateSpecializationDecl>(getRecordDecl());
     auto const &templateArgs = recordDecl->getTemplateArgs();
     assert (templateArgs.size() == 1 && "expected message_filters::Subscriber to have exactly one template argument");
@@ -70,7 +71,7 @@ private:
   }
 
   clang::CXXRecordDecl const * getFormatDecl() const {
-    llvm::outs() << "DEBUG: fetching formatdecl for message_filters::Subscriber call\n";
+    Log::outs() << "DEBUG: fetching formatdecl for message_filters::Subscriber call\n";
     auto qualType = getFormatTemplateArg().getAsType().getNonReferenceType().getUnqualifiedType();
     auto *recordType = clang::dyn_cast<clang::RecordType>(qualType.getTypePtr());
     auto const *recordDecl = clang::dyn_cast<clang::CXXRecordDecl>(recordType->getDecl());
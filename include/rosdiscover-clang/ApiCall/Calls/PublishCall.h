@@ -2,6 +2,7 @@
 
 #include <clang/AST/ASTContext.h>
 
+#include "../../Helper/Log.h"
 #include "../RosApiCall.h"
 #include "./Util.h"
 
@@ -17,38 +18,38 @@ public:
   }
 
   const std::string getPublisherName(clang::ASTContext &astContext) const {
-    llvm::outs() << "DEBUG [PublishCall] Publish call is : ";
-    getCallExpr()->dump();
-    llvm::outs() << "\n";
+    Log::outs() << "DEBUG [PublishCall] Publish call is : ";
+    getCallExpr()->dump(Log::outs(), astContext);
+    Log::outs() << "\n";
 
     const auto *memberCall = clang::dyn_cast<clang::CXXMemberCallExpr>(getCallExpr());
     if (memberCall == nullptr) {
-      llvm::outs() << "ERROR [PublishCall] Publish call is not a CXXMemberCallExpr: ";
-      getCallExpr()->dump();
-      llvm::outs() << "\n";
+      Log::outs() << "ERROR [PublishCall] Publish call is not a CXXMemberCallExpr: ";
+      getCallExpr()->dump(Log::outs(), astContext);
+      Log::outs() << "\n";
       return nullptr;
     }
     
     const clang::ValueDecl *decl = getCallerDecl("PublishCall", memberCall);
     if (decl == nullptr) {
-      llvm::outs() << "ERROR [PublishCall] Decl is null: ";
-      memberCall->dump();
-      llvm::outs() << "\n";
+      Log::outs() << "ERROR [PublishCall] Decl is null: ";
+      memberCall->dump(Log::outs(), astContext);
+      Log::outs() << "\n";
       return rosdiscover::prettyPrint(memberCall->getCallee(), astContext);
     }
 
-    llvm::outs() << "DEBUG [PublishCall] decl: ";
-    decl->dump();
-    llvm::outs() << "\n";
+    Log::outs() << "DEBUG [PublishCall] decl: ";
+    decl->dump(Log::outs());
+    Log::outs() << "\n";
 
     const auto *identifier = decl->getIdentifier();
     if (identifier == nullptr) {
-      llvm::outs() << "ERROR [PublishCall] Decl identifier is null: ";
-      decl->dump();
-      llvm::outs() << "\n";
+      Log::outs() << "ERROR [PublishCall] Decl identifier is null: ";
+      decl->dump(Log::outs());
+      Log::outs() << "\n";
       return nullptr;
     }
-    llvm::outs() << "DEBUG [PublishCall] Callee is: " << identifier->getName() << "\n";
+    Log::outs() << "DEBUG [PublishCall] Callee is: " << identifier->getName() << "\n";
 
     return identifier->getName().str();
   }
@@ -5,6 +5,7 @@
 #include <llvm/ADT/APSInt.h>
 #include <llvm/ADT/APFloat.h>
 
+#include "../../Helper/Log.h"
 #include "./Util.h"
 #include "../RosApiCall.h"
 
@@ -20,16 +21,16 @@ public:
   }
 
   clang::APValue const * getRate(const clang::ASTContext &ctx) const {
-    llvm::outs() << "DEBUG [RateSleepCall]: Getting Rate for: ";
-    getCallExpr()->dump();
-    llvm::outs() << "\n";
+    Log::outs() << "DEBUG [RateSleepCall]: Getting Rate for: ";
+    getCallExpr()->dump(Log::outs(), ctx);
+    Log::outs() << "\n";
     
     //Check input
     const auto *memberCallExpr = clang::dyn_cast<clang::CXXMemberCallExpr>(getCallExpr());
     if (memberCallExpr == nullptr) {
-      llvm::outs() << "ERROR [RateSleepCall]: Sleep call is not a CXXMemberCallExpr: ";
-      getCallExpr()->dump();
-      llvm::outs() << "\n";
+      Log::outs() << "ERROR [RateSleepCall]: Sleep call is not a CXXMemberCallExpr: ";
+      getCallExpr()->dump(Log::outs(), ctx);
+      Log::outs() << "\n";
       return nullptr;
     }
     
@@ -42,15 +43,15 @@ public:
     //check if declaration of rate object is a VarDecl,
     auto *varDecl = clang::dyn_cast<clang::VarDecl>(decl);
     if (varDecl == nullptr) {
-      llvm::outs() << "ERROR [RateSleepCall]: Unsupported rate declaration type: ";
-      decl->dump();
+      Log::outs() << "ERROR [RateSleepCall]: Unsupported rate declaration type: ";
+      decl->dump(Log::outs());
       return nullptr;
     }
 
     //Get the initialization of the the rate object.
     if (!varDecl->hasInit()) {
-      llvm::outs() << "ERROR [RateSleepCall]: Rate declaration has no init: ";
-      decl->dump();
+      Log::outs() << "ERROR [RateSleepCall]: Rate declaration has no init: ";
+      decl->dump(Log::outs());
       return nullptr;     
     }
     auto *rateInit = varDecl->getInit();
@@ -58,14 +59,14 @@ public:
     //Get the constructor of the rate object initializtion.
     const auto *rateConstructor = clang::dyn_cast<clang::CXXConstructExpr>(rateInit);
     if (rateConstructor == nullptr) {
-      llvm::outs() << "ERROR [RateSleepCall]: Decl has no init: ";
-      decl->dump();
+      Log::outs() << "ERROR [RateSleepCall]: Decl has no init: ";
+      decl->dump(Log::outs());
       return nullptr;         
     }
 
     //Get the frequency argument of the rate constructor
     const auto *frequencyArg = rateConstructor->getArg(0)->IgnoreImpCasts();
-    llvm::outs() << "DEBUG [RateSleepCall]: Rate found (" << frequencyArg->getStmtClassName() << ")\n";
+    Log::outs() << "DEBUG [RateSleepCall]: Rate found (" << frequencyArg->getStmtClassName() << ")\n";
     return evaluateNumber("RateSleepCall", frequencyArg, ctx);
   }
 
@@ -2,6 +2,7 @@
 
 #include <clang/AST/TemplateBase.h>
 
+#include "../../Helper/Log.h"
 #include "../../Helper/FormatHelper.h"
 #include "../RosApiCall.h"
 
@@ -20,18 +21,18 @@ public:
     auto *callExpr = getCallExpr();
     auto numArgs = callExpr->getNumArgs();
 
-    llvm::outs() << "[SubscribeTopicCall] Finding Callback\n";
+    Log::outs() << "[SubscribeTopicCall] Finding Callback\n";
 
     // if the call only has one argument, then we don't know what the callback is for now
     if (numArgs < 3) {
-      llvm::outs() << "[SubscribeTopicCall] Incorrect number of arguments (" << numArgs << ")\n";
+      Log::outs() << "[SubscribeTopicCall] Incorrect number of arguments (" << numArgs << ")\n";
       return nullptr;
     }
 
     // otherwise the callback should be given by the third argument
     auto *callbackArg = callExpr->getArg(2);
     auto callback = Callback::fromArgExpr(context, this, callbackArg);
-    //llvm::outs() << "[SubscribeTopicCall] Callback Found\n";
+    //Log::outs() << "[SubscribeTopicCall] Callback Found\n";
     return callback;
   }
 
@@ -11,6 +11,8 @@
 #include <llvm/ADT/APSInt.h>
 #include <llvm/ADT/APFloat.h>
 
+#include "../../Helper/Log.h"
+#include "../../Helper/ASTContextLock.h"
 #include "../RosApiCall.h"
 
 namespace rosdiscover {
@@ -93,42 +95,45 @@ clang::APValue const * evaluateNumber(
 
   if (expr->isValueDependent()) {
     if (debugPrint) {
-      llvm::outs() << "DEBUG [" << debugTag << "]: Is value-dependent and cannot be evaluated: "; 
-      expr->dump();
-      llvm::outs() << "\n";
+      Log::outs() << "DEBUG [" << debugTag << "]: Is value-dependent and cannot be evaluated: "; 
+      expr->dump(Log::outs(), Ctx);
+      Log::outs() << "\n";
     }
 
     return nullptr;
   }
 
 
+  // constant evaluation may update state that is cached by the ASTContext
+  ASTContextLock lock;
+
   //Try evaluating the frequency as integer.
   clang::Expr::EvalResult resultInt;
 
   if (expr->EvaluateAsInt(resultInt, Ctx)) {
-    llvm::outs() << "DEBUG [" << debugTag << "]: evaluated INT: (" << resultInt.Val.getInt().getSExtValue() << ")\n";
+    Log::outs() << "DEBUG [" << debugTag << "]: evaluated INT: (" << resultInt.Val.getInt().getSExtValue() << ")\n";
     return new clang::APValue(resultInt.Val);
   }
 
   //Try evaluating the frequency as float.
   llvm::APFloat resultFloat(0.0);
   if (expr->EvaluateAsFloat(resultFloat, Ctx)) {
-    llvm::outs() << "DEBUG [" << debugTag << "]: evaluated Float: (" << resultFloat.convertToDouble() << ")\n";
+    Log::outs() << "DEBUG [" << debugTag << "]: evaluated Float: (" << resultFloat.convertToDouble() << ")\n";
     return new clang::APValue(resultFloat);
   }
 
   //Try evaluating the frequency as fixed point.
   clang::Expr::EvalResult resultFixed;
   if (expr->EvaluateAsFixedPoint(resultFixed, Ctx)) {
-    llvm::outs() << "DEBUG [" << debugTag << "]: evaluated Fixed: (" << resultFixed.Val.getFixedPoint().toString() << ")\n";
+    Log::outs() << "DEBUG [" << debugTag << "]: evaluated Fixed: (" << resultFixed.Val.getFixedPoint().toString() << ")\n";
     return new clang::APValue(resultFixed.Val.getFixedPoint());
   } 
 
   //All evaluation attempts have failed.
   if (debugPrint) {
-    llvm::outs() << "DEBUG [" << debugTag << "]: has unsupported type: "; 
-    expr->dump();
-    llvm::outs() << "\n";
+    Log::outs() << "DEBUG [" << debugTag << "]: has unsupported type: "; 
+    expr->dump(Log::outs(), Ctx);
+    Log::outs() << "\n";
   }
 
   return nullptr;
@@ -142,9 +147,9 @@ const clang::ValueDecl *getCallerDecl(const std::string debugTag, const clang::C
   {
     const auto *declRef = clang::dyn_cast<clang::DeclRefExpr>(caller);
     if (declRef == nullptr || !declRef->getDecl()) {
-      llvm::outs() << "ERROR [" << debugTag << "] Can't find declaration of CXXMemberCallExpr: ";
-      memberCallExpr->dump();
-      llvm::outs() << "\n";
+      Log::outs() << "ERROR [" << debugTag << "] Can't find declaration of CXXMemberCallExpr: ";
+      memberCallExpr->printPretty(Log::outs(), nullptr, clang::PrintingPolicy(clang::LangOptions()));
+      Log::outs() << "\n";
       return nullptr;
     }
     return declRef->getDecl();
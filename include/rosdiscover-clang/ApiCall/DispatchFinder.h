@@ -0,0 +1,276 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <clang/AST/ASTContext.h>
+#include <clang/AST/DeclCXX.h>
+#include <clang/AST/Expr.h>
+#include <clang/AST/ExprCXX.h>
+#include <clang/AST/RecursiveASTVisitor.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/Optional.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/ADT/StringSwitch.h>
+#include <llvm/Support/ErrorHandling.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
+
+#include "../Helper/FileClassifier.h"
+#include "Calls.h"
+#include "RosApiCall.h"
+
+namespace rosdiscover {
+namespace api_call {
+
+/**
+ * Finds all ROS API calls in a single traversal of the AST.
+ *
+ * Rather than running one matcher per kind of API call against every call in the AST, this
+ * visits each call once and looks up the kind of API call for its callee in a table. The kind
+ * of each callee is resolved by name the first time that it is seen, and is then cached by the
+ * address of its canonical decl. The matchers of the individual RosApiCall::Finder classes
+ * describe the same calls and remain the reference for what is matched here.
+ *
+ * The traversal is scoped to the files that we analyze: decls that are located in the ROS
+ * language bindings, or outside of the paths that the analysis is restricted to, are skipped
+ * along with their entire subtree. Files are classified by a FileClassifier, which may be shared
+ * with other analyses of the same AST.
+ */
+class RosApiCallDispatchFinder : public clang::RecursiveASTVisitor<RosApiCallDispatchFinder> {
+public:
+  static std::vector<RosApiCall*> find(clang::ASTContext &context, FileClassifier &fileClassifier) {
+    RosApiCallDispatchFinder finder(context, fileClassifier);
+    finder.TraverseAST(context);
+    return finder.calls;
+  }
+
+  /**
+   * Finds all API calls using several threads (0 uses all cores). The top-level decls of the
+   * translation unit are split into contiguous shards, each of which is traversed by its own
+   * finder, and the calls of each shard are concatenated in source order.
+   *
+   * The AST is only read during the traversal, unless it is backed by an external source (e.g.,
+   * an AST file) that deserializes decls on demand. Such ASTs are traversed on a single thread.
+   */
+  static std::vector<RosApiCall*> find(
+      clang::ASTContext &context,
+      FileClassifier &fileClassifier,
+      unsigned numJobs
+  ) {
+    auto *unit = context.getTranslationUnitDecl();
+    std::vector<clang::Decl*> decls(unit->decls_begin(), unit->decls_end());
+    size_t numThreads = llvm::hardware_concurrency(numJobs).compute_thread_count();
+    // use more shards than threads, since the size of top-level decls varies wildly
+    size_t numShards = std::min(decls.size(), numThreads * 4);
+    if (numThreads <= 1 || numShards <= 1 || context.getExternalSource() != nullptr) {
+      return find(context, fileClassifier);
+    }
+
+    std::vector<FileClassifier> shardClassifiers(numShards, fileClassifier);
+    std::vector<std::vector<RosApiCall*>> shardCalls(numShards);
+    llvm::ThreadPool pool(llvm::hardware_concurrency(numJobs));
+    for (size_t shard = 0; shard < numShards; ++shard) {
+      size_t begin = decls.size() * shard / numShards;
+      size_t end = decls.size() * (shard + 1) / numShards;
+      pool.async([&context, &decls, &shardClassifiers, &shardCalls, shard, begin, end] {
+        RosApiCallDispatchFinder finder(context, shardClassifiers[shard]);
+        for (size_t i = begin; i < end; ++i) {
+          finder.TraverseDecl(decls[i]);
+        }
+        shardCalls[shard] = std::move(finder.calls);
+      });
+    }
+    pool.wait();
+
+    std::vector<RosApiCall*> calls;
+    for (auto &callsInShard : shardCalls) {
+      calls.insert(calls.end(), callsInShard.begin(), callsInShard.end());
+    }
+    return calls;
+  }
+
+  bool TraverseDecl(clang::Decl *decl) {
+    // decl contexts that span several files are always entered, and their members are checked
+    if (
+         decl == nullptr
+      || clang::isa<clang::TranslationUnitDecl>(decl)
+      || clang::isa<clang::NamespaceDecl>(decl)
+      || clang::isa<clang::LinkageSpecDecl>(decl)
+      || isAnalyzed(decl->getLocation())
+    ) {
+      return clang::RecursiveASTVisitor<RosApiCallDispatchFinder>::TraverseDecl(decl);
+    }
+    return true;
+  }
+
+  // mirror the default traversal of the AST matchers
+  bool shouldVisitTemplateInstantiations() const { return true; }
+  bool shouldVisitImplicitCode() const { return true; }
+
+  bool VisitCallExpr(clang::CallExpr *call) {
+    auto const *callee = clang::dyn_cast_or_null<clang::FunctionDecl>(call->getCalleeDecl());
+    if (callee == nullptr) {
+      return true;
+    }
+    auto kind = getKind(callee);
+    if (kind && *kind != RosApiCallKind::MessageFiltersSubscriberCall) {
+      add(build(*kind, call));
+    }
+    return true;
+  }
+
+  bool VisitCXXConstructExpr(clang::CXXConstructExpr *call) {
+    auto const *constructor = call->getConstructor();
+    if (constructor == nullptr) {
+      return true;
+    }
+    auto kind = getKind(constructor);
+    if (kind && *kind == RosApiCallKind::MessageFiltersSubscriberCall) {
+      add(new MessageFiltersSubscriberCall(call));
+    }
+    return true;
+  }
+
+private:
+  clang::SourceManager const &sourceManager;
+  FileClassifier &fileClassifier;
+  llvm::DenseMap<clang::FunctionDecl const *, llvm::Optional<RosApiCallKind>> calleeToKind;
+  std::vector<RosApiCall*> calls;
+
+  RosApiCallDispatchFinder(clang::ASTContext &context, FileClassifier &fileClassifier)
+    : sourceManager(context.getSourceManager()),
+      fileClassifier(fileClassifier),
+      calleeToKind(),
+      calls()
+  {}
+
+  void add(RosApiCall *call) {
+    calls.push_back(call);
+  }
+
+  /** Determines whether API calls at a given location should be found. */
+  bool isAnalyzed(clang::SourceLocation location) {
+    return fileClassifier.classify(sourceManager, location) == FileKind::Allowed;
+  }
+
+  llvm::Optional<RosApiCallKind> getKind(clang::FunctionDecl const *callee) {
+    callee = callee->getCanonicalDecl();
+    auto it = calleeToKind.find(callee);
+    if (it != calleeToKind.end()) {
+      return it->second;
+    }
+    auto kind = resolveKind(callee);
+    calleeToKind[callee] = kind;
+    return kind;
+  }
+
+  /** Determines the kind of API call, if any, that a call to a given function corresponds to. */
+  static llvm::Optional<RosApiCallKind> resolveKind(clang::FunctionDecl const *callee) {
+    if (auto const *constructor = clang::dyn_cast<clang::CXXConstructorDecl>(callee)) {
+      if (constructor->getParent()->getQualifiedNameAsString() == "message_filters::Subscriber") {
+        return RosApiCallKind::MessageFiltersSubscriberCall;
+      }
+      return llvm::None;
+    }
+
+    if (callee->getIdentifier() == nullptr) {
+      return llvm::None;
+    }
+    llvm::StringRef name = callee->getName();
+
+    if (auto const *method = clang::dyn_cast<clang::CXXMethodDecl>(callee)) {
+      auto className = method->getParent()->getQualifiedNameAsString();
+      if (className == "ros::NodeHandle") {
+        return llvm::StringSwitch<llvm::Optional<RosApiCallKind>>(name)
+          .Case("advertiseService", RosApiCallKind::AdvertiseServiceCall)
+          .Case("advertise", RosApiCallKind::AdvertiseTopicCall)
+          .Case("deleteParam", RosApiCallKind::DeleteParamCall)
+          .Case("getParamCached", RosApiCallKind::GetParamCachedCall)
+          .Case("getCached", RosApiCallKind::GetParamCachedCall)
+          .Case("getParam", RosApiCallKind::GetParamCall)
+          .Case("param", RosApiCallKind::GetParamWithDefaultCall)
+          .Case("hasParam", RosApiCallKind::HasParamCall)
+          .Case("serviceClient", RosApiCallKind::ServiceClientCall)
+          .Case("setParam", RosApiCallKind::SetParamCall)
+          .Case("subscribe", RosApiCallKind::SubscribeTopicCall)
+          .Default(llvm::None);
+      }
+      if (className == "ros::Publisher" && name == "publish") {
+        return RosApiCallKind::PublishCall;
+      }
+      if (className == "ros::Rate" && name == "sleep") {
+        return RosApiCallKind::RateSleepCall;
+      }
+      return llvm::None;
+    }
+
+    // all bare API calls live in the ros namespace
+    if (!callee->getDeclContext()->isNamespace()) {
+      return llvm::None;
+    }
+    return llvm::StringSwitch<llvm::Optional<RosApiCallKind>>(callee->getQualifiedNameAsString())
+      .Case("ros::param::del", RosApiCallKind::BareDeleteParamCall)
+      .Case("ros::param::getCached", RosApiCallKind::BareGetParamCachedCall)
+      .Case("ros::param::get", RosApiCallKind::BareGetParamCall)
+      .Case("ros::param::param", RosApiCallKind::BareGetParamWithDefaultCall)
+      .Case("ros::param::has", RosApiCallKind::BareHasParamCall)
+      .Case("ros::service::call", RosApiCallKind::BareServiceCall)
+      .Case("ros::param::set", RosApiCallKind::BareSetParamCall)
+      .Case("ros::init", RosApiCallKind::RosInitCall)
+      .Default(llvm::None);
+  }
+
+  /** Builds the API call of a given kind for a call expression. */
+  static RosApiCall* build(RosApiCallKind kind, clang::CallExpr const *call) {
+    switch (kind) {
+      case RosApiCallKind::AdvertiseServiceCall:
+        return new AdvertiseServiceCall(call);
+      case RosApiCallKind::AdvertiseTopicCall:
+        return new AdvertiseTopicCall(call);
+      case RosApiCallKind::BareDeleteParamCall:
+        return new BareDeleteParamCall(call);
+      case RosApiCallKind::BareGetParamCachedCall:
+        return new BareGetParamCachedCall(call);
+      case RosApiCallKind::BareGetParamCall:
+        return new BareGetParamCall(call);
+      case RosApiCallKind::BareGetParamWithDefaultCall:
+        return new BareGetParamWithDefaultCall(call);
+      case RosApiCallKind::BareHasParamCall:
+        return new BareHasParamCall(call);
+      case RosApiCallKind::BareServiceCall:
+        return new BareServiceCall(call);
+      case RosApiCallKind::BareSetParamCall:
+        return new BareSetParamCall(call);
+      case RosApiCallKind::DeleteParamCall:
+        return new DeleteParamCall(call);
+      case RosApiCallKind::GetParamCachedCall:
+        return new GetParamCachedCall(call);
+      case RosApiCallKind::GetParamCall:
+        return new GetParamCall(call);
+      case RosApiCallKind::GetParamWithDefaultCall:
+        return new GetParamWithDefaultCall(call);
+      case RosApiCallKind::HasParamCall:
+        return new HasParamCall(call);
+      case RosApiCallKind::PublishCall:
+        return new PublishCall(call);
+      case RosApiCallKind::RateSleepCall:
+        return new RateSleepCall(call);
+      case RosApiCallKind::RosInitCall:
+        return new RosInitCall(call);
+      case RosApiCallKind::ServiceClientCall:
+        return new ServiceClientCall(call);
+      case RosApiCallKind::SetParamCall:
+        return new SetParamCall(call);
+      case RosApiCallKind::SubscribeTopicCall:
+        return new SubscribeTopicCall(call);
+      case RosApiCallKind::MessageFiltersSubscriberCall:
+        break;
+    }
+    llvm_unreachable("message_filters::Subscriber calls are constructor calls");
+  }
+};
+
+} // rosdiscover::api_call
+} // rosdiscover
@@ -1,11 +1,14 @@
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include <clang/ASTMatchers/ASTMatchFinder.h>
 #include <clang/Tooling/Tooling.h>
 
+#include "../Helper/FileClassifier.h"
 #include "Calls.h"
+#include "DispatchFinder.h"
 #include "RosApiCall.h"
 
 namespace rosdiscover {
@@ -15,16 +18,46 @@ namespace api_call {
 class RosApiCallFinder {
 public:
 
-  static std::vector<RosApiCall*> find(clang::tooling::ClangTool &tool) {
-    return RosApiCallFinder().run(tool);
+  /**
+   * Finds all API calls within a program described by a clang tool.
+   * If a list of paths is given, only API calls within files under those paths are found.
+   */
+  static std::vector<RosApiCall*> find(
+      clang::tooling::ClangTool &tool,
+      std::vector<std::string> const &restrictAnalysisToPaths = {}
+  ) {
+    FileClassifier fileClassifier(restrictAnalysisToPaths);
+    return RosApiCallFinder(fileClassifier).run(tool);
   }
 
-  static std::vector<RosApiCall*> find(clang::ASTContext &context) {
-    return RosApiCallFinder().run(context);
+  /**
+   * Finds all API calls within an AST, using a single traversal (see RosApiCallDispatchFinder).
+   * Only API calls within files that the given classifier allows are found. The traversal is
+   * sharded across the given number of threads (0 uses all cores).
+   */
+  static std::vector<RosApiCall*> find(
+      clang::ASTContext &context,
+      FileClassifier &fileClassifier,
+      unsigned numJobs = 1
+  ) {
+    if (numJobs == 1) {
+      return RosApiCallDispatchFinder::find(context, fileClassifier);
+    }
+    return RosApiCallDispatchFinder::find(context, fileClassifier, numJobs);
+  }
+
+  /** Finds all API calls within an AST that belong to files under the given paths, if any. */
+  static std::vector<RosApiCall*> find(
+      clang::ASTContext &context,
+      std::vector<std::string> const &restrictAnalysisToPaths = {}
+  ) {
+    FileClassifier fileClassifier(restrictAnalysisToPaths);
+    return find(context, fileClassifier);
   }
 
 private:
-  RosApiCallFinder() :
+  RosApiCallFinder(FileClassifier &fileClassifier) :
+    fileClassifier(fileClassifier),
     callFinders(),
     matchFinder(),
     calls()
@@ -63,6 +96,7 @@ private:
   }
 
   void addFinder(RosApiCall::Finder *finder) {
+    finder->setFileClassifier(fileClassifier);
     callFinders.push_back(finder);
     matchFinder.addMatcher(finder->getPattern(), finder);
   }
@@ -77,12 +111,8 @@ private:
     return calls;
   }
 
-  std::vector<RosApiCall*> run(clang::ASTContext &context) {
-    matchFinder.matchAST(context);
-    return calls;
-  }
-
 private:
+  FileClassifier &fileClassifier;
   std::vector<RosApiCall::Finder*> callFinders;
   clang::ast_matchers::MatchFinder matchFinder;
   std::vector<RosApiCall*> calls;
@@ -9,7 +9,9 @@
 #include <clang/ASTMatchers/ASTMatchFinder.h>
 #include <llvm/Support/raw_ostream.h>
 
+#include "../Helper/Log.h"
 #include "../Helper/utils.h"
+#include "../Helper/FileClassifier.h"
 #include "../Helper/CallOrConstructExpr.h"
 #include "Calls/Kind.h"
 
@@ -57,16 +59,10 @@ public:
   public:
     void run(const clang::ast_matchers::MatchFinder::MatchResult &result) {
       if (auto *apiCall = build(result)) {
-        auto const *callExpr = apiCall->getCallOrConstructExpr();
-
-        // NOTE c++20 provides std::string::ends_with
-        // ignore any calls that happen within the ROS language bindings
-        std::string filename = clang::FullSourceLoc(callExpr->getBeginLoc(), *result.SourceManager).getFileEntry()->getName().str();
-        if (
-             ends_with(filename, "/include/ros/node_handle.h")
-          || ends_with(filename, "/include/ros/param.h")
-          || ends_with(filename, "/include/ros/service.h")
-        ) {
+        // ignore any calls that happen within the ROS language bindings or outside the analyzed paths
+        auto kind = fileClassifier->classify(*result.SourceManager, apiCall->getExpr()->getBeginLoc());
+        if (kind != FileKind::Allowed) {
+          delete apiCall;
           return;
         }
 
@@ -74,16 +70,25 @@ public:
       }
     }
 
+    /** Shares a classifier of source files between this and other finders. */
+    void setFileClassifier(FileClassifier &classifier) {
+      fileClassifier = &classifier;
+    }
+
     virtual const clang::ast_matchers::StatementMatcher getPattern() = 0;
 
   protected:
-    Finder(std::vector<RosApiCall*> &found) : found(found) {}
+    Finder(std::vector<RosApiCall*> &found)
+      : found(found), defaultFileClassifier(), fileClassifier(&defaultFileClassifier)
+    {}
 
     virtual RosApiCall* build(clang::ast_matchers::MatchFinder::MatchResult const &result) = 0;
 
 
   private:
     std::vector<RosApiCall*> &found;
+    FileClassifier defaultFileClassifier;
+    FileClassifier *fileClassifier;
   };
 
   virtual void print(llvm::raw_ostream &os) const {
@@ -94,15 +99,13 @@ public:
 
 protected:
   clang::CXXRecordDecl const * getTypeDeclFromTemplateArgument(clang::TemplateArgument const &templateArgument) const {
-    llvm::outs() << "DEBUG: fetching type decl for template argument: ";
-    templateArgument.dump();
-    llvm::outs() << "\n";
+    Log::outs() << "DEBUG: fetching type decl for template argument: ";
+    templateArgument.dump(Log::outs());
+    Log::outs() << "\n";
 
     auto qualType = templateArgument.getAsType().getNonReferenceType().getUnqualifiedType();
 
-    llvm::outs() << "DEBUG: found unqualified type: ";
-    qualType.dump();
-    llvm::outs() << "\n";
+    Log::outs() << "DEBUG: found unqualified type: " << qualType.getAsString() << "\n";
 
     auto *recordType = clang::dyn_cast<clang::RecordType>(qualType.getTypePtr());
     auto const *recordDecl = clang::dyn_cast<clang::CXXRecordDecl>(recordType->getDecl());
@@ -177,9 +180,9 @@ public:
       return memberExpr->getMemberDecl();
 
     } else {
-      llvm::errs() << "unable to fetch decl for node handle expr: ";
-      nodeHandleExpr->dumpColor();
-      llvm::errs() << "\n";
+      Log::errs() << "unable to fetch decl for node handle expr: ";
+      nodeHandleExpr->printPretty(Log::errs(), nullptr, clang::PrintingPolicy(clang::LangOptions()));
+      Log::errs() << "\n";
       abort();
     }
   }
@@ -11,9 +11,7 @@ class FindVarAssignVisitor
   : public clang::RecursiveASTVisitor<FindVarAssignVisitor> {
 public:
   FindVarAssignVisitor(
-    std::vector<const clang::BinaryOperator *> &results,
-    clang::ASTContext &astContext, 
-    std::unordered_map<clang::Expr const *, SymbolicVariable *> &apiCallToVar) : exprSymbolizer(astContext, apiCallToVar), results(results) {}
+    std::vector<const clang::BinaryOperator *> &results) : results(results) {}
 
   bool shouldVisitImplicitCode () const {
     return true;
@@ -35,17 +33,14 @@ public:
     return results;
   }
 
-  static std::vector<const clang::BinaryOperator *> findAssignments(clang::ASTContext &astContext, 
-    std::unordered_map<clang::Expr const *, SymbolicVariable *> &apiCallToVar,
-    const clang::FunctionDecl *function) {
+  static std::vector<const clang::BinaryOperator *> findAssignments(const clang::FunctionDecl *function) {
     std::vector<const clang::BinaryOperator *> results = {};
-    FindVarAssignVisitor visitor(results, astContext, apiCallToVar);
+    FindVarAssignVisitor visitor(results);
     visitor.TraverseDecl(const_cast<clang::FunctionDecl*>(function));
     return results;
   }
 
 private:
-  ExprSymbolizer exprSymbolizer;
   std::vector<const clang::BinaryOperator *> &results;
 };
 
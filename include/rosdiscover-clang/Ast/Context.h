@@ -1,53 +1,104 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <clang/AST/ASTContext.h>
+#include <llvm/ADT/DenseMap.h>
 
 #include <nlohmann/json.hpp>
 
+#include "../Helper/Log.h"
+#include "../Helper/utils.h"
 #include "Function.h"
 #include "Stmt/Stmt.h"
 
 namespace rosdiscover {
 
+/**
+ * Holds the symbolic functions of a program. Functions are identified by their USR (see
+ * getFunctionId), which distinguishes overloads and is stable across translation units.
+ * Lookups by decl are memoized by canonical decl, so that the USR of a function is only
+ * generated once. Functions may be declared, defined and looked up from several threads.
+ */
 class SymbolicContext {
 public:
-  SymbolicContext() : nameToFunction() {}
+  SymbolicContext() : mutex(), idToFunction(), declToFunction(), linkedDeclarations() {}
 
   SymbolicFunction* declare(clang::ASTContext const &astContext, clang::FunctionDecl const *function) {
-    auto qualifiedName = function->getQualifiedNameAsString();
-    nameToFunction.emplace(
-        qualifiedName,
-        std::unique_ptr<SymbolicFunction>(SymbolicFunction::create(astContext, function))
-    );
-    auto symbolic = getDefinition(qualifiedName);
-    llvm::outs() << "declared symbolic function: " << symbolic->getName() << "\n";
-    return symbolic;
+    auto const *canonical = function->getCanonicalDecl();
+    auto id = getFunctionId(canonical);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &symbolic = idToFunction[id];
+    if (symbolic == nullptr) {
+      symbolic.reset(SymbolicFunction::create(astContext, function));
+    }
+    declToFunction[canonical] = symbolic.get();
+    Log::outs() << "declared symbolic function: " << symbolic->getName() << "\n";
+    return symbolic.get();
   }
 
   void define(clang::FunctionDecl const *function, std::unique_ptr<SymbolicCompound> body) {
-    define(function->getQualifiedNameAsString(), std::move(body));
+    std::lock_guard<std::mutex> lock(mutex);
+    find(function)->define(std::move(body));
   }
 
-  void define(std::string const &qualifiedName, std::unique_ptr<SymbolicCompound> body) {
-    auto *function = getDefinition(qualifiedName);
-    function->define(std::move(body));
+  void define(std::string const &id, std::unique_ptr<SymbolicCompound> body) {
+    std::lock_guard<std::mutex> lock(mutex);
+    find(id)->define(std::move(body));
   }
 
+  /** Returns the symbolic function for a given function, or nullptr if it hasn't been declared. */
   SymbolicFunction* getDefinition(clang::FunctionDecl const *function) {
-    return getDefinition(function->getQualifiedNameAsString());
+    std::lock_guard<std::mutex> lock(mutex);
+    return find(function);
+  }
+
+  /** Returns the symbolic function with a given ID, or nullptr if it hasn't been declared. */
+  SymbolicFunction* getDefinition(std::string const &id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return find(id);
   }
 
-  SymbolicFunction* getDefinition(std::string const &qualifiedName) {
-    return nameToFunction[qualifiedName].get();
+  /**
+   * Moves all functions of another context into this one. If both contexts contain the same
+   * function, its definition is kept over a mere declaration. Functions that are superseded
+   * are kept alive, since calls in the linked function bodies may still refer to them.
+   */
+  void link(SymbolicContext &other) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto &entry : other.idToFunction) {
+      if (entry.second == nullptr) {
+        continue;
+      }
+      auto it = idToFunction.find(entry.first);
+      if (it == idToFunction.end() || it->second == nullptr) {
+        idToFunction[entry.first] = std::move(entry.second);
+      } else if (!it->second->isDefined() && entry.second->isDefined()) {
+        linkedDeclarations.push_back(std::move(it->second));
+        it->second = std::move(entry.second);
+      } else {
+        linkedDeclarations.push_back(std::move(entry.second));
+      }
+    }
+    other.idToFunction.clear();
+    for (auto &declaration : other.linkedDeclarations) {
+      linkedDeclarations.push_back(std::move(declaration));
+    }
+    other.linkedDeclarations.clear();
+
+    // the decls of a linked context belong to an AST that may be destroyed, and linking may
+    // replace the functions that our own decls refer to
+    other.declToFunction.clear();
+    declToFunction.clear();
   }
 
   void print(llvm::raw_ostream &os) const {
     os << "context {\n";
-    for (auto const &entry : nameToFunction) {
+    for (auto const &entry : idToFunction) {
       entry.second->print(os);
       os << "\n";
     }
@@ -56,15 +107,36 @@ public:
 
   nlohmann::json toJson() const {
     auto j = nlohmann::json::array();
-    for (auto const &entry : nameToFunction) {
+    for (auto const &entry : idToFunction) {
       j.push_back(entry.second->toJson());
     }
     return {{"functions", j}};
   }
 
 private:
+  std::mutex mutex;
   // no need for unique_ptr; getters should just return references
-  std::unordered_map<std::string, std::unique_ptr<SymbolicFunction>> nameToFunction;
+  std::unordered_map<std::string, std::unique_ptr<SymbolicFunction>> idToFunction;
+  llvm::DenseMap<clang::FunctionDecl const *, SymbolicFunction *> declToFunction;
+  std::vector<std::unique_ptr<SymbolicFunction>> linkedDeclarations;
+
+  SymbolicFunction* find(clang::FunctionDecl const *function) {
+    auto const *canonical = function->getCanonicalDecl();
+    auto it = declToFunction.find(canonical);
+    if (it != declToFunction.end()) {
+      return it->second;
+    }
+    auto *symbolic = find(getFunctionId(canonical));
+    if (symbolic != nullptr) {
+      declToFunction[canonical] = symbolic;
+    }
+    return symbolic;
+  }
+
+  SymbolicFunction* find(std::string const &id) {
+    auto it = idToFunction.find(id);
+    return it == idToFunction.end() ? nullptr : it->second.get();
+  }
 };
 
 } // rosdiscover
@@ -8,16 +8,24 @@
 
 #include <fmt/core.h>
 
+#include "../Helper/Log.h"
+#include "../Helper/utils.h"
 #include "../Value/Value.h"
 #include "../Value/Bool.h"
 #include "Decl/LocalVariable.h"
 #include "Decl/Parameter.h"
 #include "Stmt/Stmt.h"
 #include "Stmt/Compound.h"
+#include "Stmt/SymbolicExpr.h"
 #include "Stmt/ControlDependency.h"
 
 namespace rosdiscover {
 
+/**
+ * A symbolic function. Functions are identified in the JSON output by their "id" (i.e., their
+ * USR; see getFunctionId), since overloads and static functions in different translation units
+ * may share the same qualified "name". Calls refer to their callee by that id.
+ */
 class SymbolicFunction {
 public:
   void print(llvm::raw_ostream &os) const {
@@ -36,16 +44,31 @@ public:
       jsonParams.push_back(entry.second.toJson());
     }
 
-    return {
+    // subexpressions that are shared by several path conditions within the body are referred to
+    // by their "id" in "shared-exprs", which is only present if there are any
+    SharedExprTable sharedExprs;
+    auto jsonBody = sharedExprs.serialize(*body);
+    nlohmann::json j = {
+      {"id", id},
       {"name", qualifiedName},
       {"parameters", jsonParams},
       {"source-location", location},
-      {"body", body.get()->toJson()}
+      {"body", jsonBody}
     };
+    if (!sharedExprs.empty()) {
+      j["shared-exprs"] = sharedExprs.toJson();
+    }
+    return j;
   }
 
   void define(std::unique_ptr<SymbolicCompound> body) {
     this->body = std::move(body);
+    defined = true;
+  }
+
+  /** Indicates whether this function has been given a definition, rather than just being declared. */
+  bool isDefined() const {
+    return defined;
   }
 
   LocalVariable* createLocal(SymbolicValueType const &type) {
@@ -58,13 +81,19 @@ public:
     return qualifiedName;
   }
 
+  /** Returns the identifier of this function, which is unique within a program. */
+  std::string getId() const {
+    return id;
+  }
+
   static SymbolicFunction* create(
       clang::ASTContext const &context,
       clang::FunctionDecl const *function
   ) {
+    auto id = getFunctionId(function->getCanonicalDecl());
     auto qualifiedName = function->getQualifiedNameAsString();
     auto location = function->getLocation().printToString(context.getSourceManager());
-    auto symbolic = new SymbolicFunction(qualifiedName, location);
+    auto symbolic = new SymbolicFunction(id, qualifiedName, location);
 
     // TODO check whether this is the "main" function
     auto numParams = function->getNumParams();
@@ -84,19 +113,24 @@ public:
   }
 
 private:
+  std::string id;
   std::string qualifiedName;
   std::string location;
   std::unique_ptr<SymbolicCompound> body;
+  bool defined;
   size_t nextLocalNumber;
   std::unordered_map<size_t, Parameter> parameters;
   std::vector<std::unique_ptr<LocalVariable>> locals;
 
   SymbolicFunction(
+    std::string const &id,
     std::string const &qualifiedName,
     std::string const &location
-  ) : qualifiedName(qualifiedName),
+  ) : id(id),
+      qualifiedName(qualifiedName),
       location(location),
       body(std::make_unique<SymbolicCompound>()),
+      defined(false),
       nextLocalNumber(0),
       parameters(),
       locals()
@@ -110,7 +144,7 @@ private:
     auto type = SymbolicValue::getSymbolicType(paramType);
 
     if (type == SymbolicValueType::Unsupported) {
-      llvm::outs()
+      Log::outs()
         << "DEBUG: type ["
         << paramTypeName
         << "] of parameter ["
@@ -119,7 +153,7 @@ private:
       return;
     }
 
-    llvm::outs() << "DEBUG: created symbolic parameter [" << name << "]\n";
+    Log::outs() << "DEBUG: created symbolic parameter [" << name << "]\n";
     addParam(Parameter(index, name, type));
   }
 
@@ -172,6 +206,7 @@ public:
     return {
       {"kind", "call"},
       {"callee", callee->getName()},
+      {"callee-id", callee->getId()},
       {"arguments", argsJson},
       {"path_condition", pathCondition->toJson()},
     };
@@ -181,6 +216,10 @@ public:
     return callee->getName();
   }
 
+  virtual std::string const getCalleeId() const {
+    return callee->getId();
+  }
+
 private:
   SymbolicFunction *callee;
   std::unordered_map<std::string, std::unique_ptr<SymbolicValue>> args;
@@ -211,6 +250,10 @@ public:
   std::string const getCalleeName() const override {
     return "unknown";
   }
+
+  std::string const getCalleeId() const override {
+    return "unknown";
+  }
 };
 
 } // rosdiscover
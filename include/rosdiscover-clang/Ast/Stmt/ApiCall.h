@@ -88,7 +88,8 @@ public:
       {"kind", "subscribes-to"},
       {"name", getName()->toJson()},
       {"format", format},
-      {"callback-name", (callback == nullptr) ? "unknown" : callback->getCalleeName()}
+      {"callback-name", (callback == nullptr) ? "unknown" : callback->getCalleeName()},
+      {"callback-id", (callback == nullptr) ? "unknown" : callback->getCalleeId()}
     };
   }
 
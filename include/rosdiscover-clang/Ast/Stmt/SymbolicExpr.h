@@ -1,5 +1,11 @@
 #pragma once
 
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../../Helper/Log.h"
 #include "Stmt.h"
 
 namespace rosdiscover {
@@ -15,11 +21,20 @@ public:
     return {};
   }
 
+  /** Returns all distinct transitive children of this expression, even if some are shared. */
   std::vector<const SymbolicExpr*> getDescendants() const {
-    std::vector<const SymbolicExpr*> result = getChildren();
-    for (auto child: getChildren()) {
-      auto transitiveChildren = child->getDescendants();
-      result.insert(result.end(), transitiveChildren.begin(), transitiveChildren.end());
+    std::vector<const SymbolicExpr*> result;
+    std::unordered_set<const SymbolicExpr*> visited;
+    std::vector<const SymbolicExpr*> worklist = getChildren();
+    while (!worklist.empty()) {
+      auto const *expr = worklist.back();
+      worklist.pop_back();
+      if (!visited.insert(expr).second) {
+        continue;
+      }
+      result.push_back(expr);
+      auto children = expr->getChildren();
+      worklist.insert(worklist.end(), children.begin(), children.end());
     }
     return result;
   }
@@ -103,6 +118,160 @@ private:
   std::unique_ptr<SymbolicExpr> subExpr;
 };
 
+/**
+ * Collects the shared subexpressions that are referenced more than once by a statement that is
+ * serialized on the current thread while this table exists. Each of them is serialized once, as
+ * part of this table, and is referred to by its number everywhere else, so that conditions that
+ * share their subexpressions (e.g., the path conditions of nested blocks) don't grow
+ * exponentially. Shared subexpressions that are referenced only once, or that are serialized
+ * without a table, are written out in full, as are all other expressions.
+ */
+class SharedExprTable {
+public:
+  SharedExprTable() : previous(getCurrent()), counting(true), numReferences(), ids(), exprs() {
+    getCurrent() = this;
+  }
+
+  ~SharedExprTable() {
+    getCurrent() = previous;
+  }
+
+  SharedExprTable(SharedExprTable const &) = delete;
+  SharedExprTable & operator=(SharedExprTable const &) = delete;
+
+  /** Returns the table that is in use on the current thread, or nullptr if there is none. */
+  static SharedExprTable * current() {
+    return getCurrent();
+  }
+
+  /**
+   * Serializes a given statement, which may only be done once per table. A first pass counts
+   * the references to each shared expression, and the second writes the statement.
+   */
+  nlohmann::json serialize(SymbolicStmt const &stmt) {
+    stmt.toJson();
+    counting = false;
+    return stmt.toJson();
+  }
+
+  /** Indicates whether the references to shared expressions are being counted. */
+  bool isCounting() const {
+    return counting;
+  }
+
+  /** Counts a reference to a given shared expression, and returns true if it is the first. */
+  bool addReference(SymbolicExpr const *expr) {
+    return ++numReferences[expr] == 1;
+  }
+
+  /** Indicates whether a given shared expression is referenced more than once. */
+  bool contains(SymbolicExpr const *expr) const {
+    auto it = numReferences.find(expr);
+    return it != numReferences.end() && it->second > 1;
+  }
+
+  /** Returns the number of a given shared expression, adding it to this table if necessary. */
+  size_t getId(SymbolicExpr const *expr) {
+    auto inserted = ids.emplace(expr, exprs.size());
+    if (inserted.second) {
+      exprs.push_back(expr);
+    }
+    return inserted.first->second;
+  }
+
+  bool empty() const {
+    return exprs.empty();
+  }
+
+  // serializing an expression may add the shared expressions that it refers to, which are then serialized as well
+  nlohmann::json toJson() {
+    auto j = nlohmann::json::array();
+    for (size_t id = 0; id < exprs.size(); ++id) {
+      j.push_back({
+        {"id", id},
+        {"expr", exprs[id]->toJson()}
+      });
+    }
+    return j;
+  }
+
+private:
+  SharedExprTable *previous;
+  bool counting;
+  std::unordered_map<SymbolicExpr const *, size_t> numReferences;
+  std::unordered_map<SymbolicExpr const *, size_t> ids;
+  std::vector<SymbolicExpr const *> exprs;
+
+  static SharedExprTable *& getCurrent() {
+    static thread_local SharedExprTable *table = nullptr;
+    return table;
+  }
+};
+
+/**
+ * Refers to an expression that is owned jointly with other statements, such as the path
+ * condition of a CFG block that is shared by all statements within that block. It is printed
+ * like the expression that it refers to, unless that expression belongs to the current
+ * SharedExprTable, in which case it is serialized as {"kind": "shared-expr", "id": N} and is
+ * printed as $N.
+ */
+class SharedExpr : public SymbolicExpr {
+public:
+  SharedExpr(
+    std::shared_ptr<SymbolicExpr const> expr
+  ) : expr(std::move(expr)) {
+    assert(this->expr != nullptr);
+  }
+  ~SharedExpr(){}
+
+  void print(llvm::raw_ostream &os) const override {
+    expr->print(os);
+  }
+
+  std::string toString() const override {
+    auto *table = SharedExprTable::current();
+    if (table == nullptr) {
+      return expr->toString();
+    }
+    // the strings that are written while counting are discarded
+    if (table->isCounting()) {
+      return "";
+    }
+    if (table->contains(expr.get())) {
+      return fmt::format("${}", table->getId(expr.get()));
+    }
+    return expr->toString();
+  }
+
+  nlohmann::json toJson() const override {
+    auto *table = SharedExprTable::current();
+    if (table == nullptr) {
+      return expr->toJson();
+    }
+    // an expression is written once, either inline or as part of the table, and so are its references
+    if (table->isCounting()) {
+      if (table->addReference(expr.get())) {
+        expr->toJson();
+      }
+      return nullptr;
+    }
+    if (!table->contains(expr.get())) {
+      return expr->toJson();
+    }
+    return {
+      {"kind", "shared-expr"},
+      {"id", table->getId(expr.get())}
+    };
+  }
+
+  std::vector<const SymbolicExpr*> getChildren() const override {
+    return {expr.get()};
+  }
+
+private:
+  std::shared_ptr<SymbolicExpr const> expr;
+};
+
 class BinaryExpr : public SymbolicExpr {
 public:
   BinaryExpr(
@@ -203,7 +372,7 @@ public:
       case clang::BinaryOperator::Opcode::BO_Cmp: 
         return CompareOperator::Spaceship;
       default:
-        llvm::outs() << "ERROR: Invalid compare operator (opCode): " << opCode;
+        Log::outs() << "ERROR: Invalid compare operator (opCode): " << opCode;
         abort();
     }
   }
@@ -231,7 +400,7 @@ public:
       case clang::OO_Spaceship:
         return CompareOperator::Spaceship;
       default:
-        llvm::outs() << "ERROR: Invalid compare operator (opCode): " << opCode;
+        Log::outs() << "ERROR: Invalid compare operator (opCode): " << opCode;
         abort();
     }
   }
@@ -293,7 +462,7 @@ public:
       case clang::BinaryOperator::Opcode::BO_Rem: 
         return BinaryMathOperator::Rem;
       default:
-        llvm::outs() << "ERROR: Invalid binary math operator: " << opCode;
+        Log::outs() << "ERROR: Invalid binary math operator: " << opCode;
         abort();
     }
   }
@@ -7,9 +7,11 @@
 #include <clang/AST/ExprCXX.h>
 #include <llvm/ADT/APInt.h>
 
+#include "../Helper/ASTContextLock.h"
+#include "../Helper/Log.h"
 #include "../Builder/ValueBuilder.h"
 #include "../Value/String.h"
-#include "../Helper/FindDefVisitor.h"
+#include "../Helper/ReachingDefinitions.h"
 
 namespace rosdiscover {
 
@@ -22,15 +24,15 @@ public:
 
   std::unique_ptr<SymbolicBool> symbolize(const clang::Expr *expr) {
     if (expr == nullptr) {
-      llvm::outs() << "ERROR! Symbolizing (bool): NULLPTR";
+      Log::outs() << "ERROR! Symbolizing (bool): NULLPTR";
       return valueBuilder.unknown();
     }
 
     expr = expr->IgnoreParenCasts()->IgnoreImpCasts()->IgnoreCasts();
 
-    llvm::outs() << "symbolizing (bool): ";
-    expr->dump();
-    llvm::outs() << "\n";
+    Log::outs() << "symbolizing (bool): ";
+    expr->dump(Log::outs(), astContext);
+    Log::outs() << "\n";
 
     if (auto *literal = clang::dyn_cast<clang::CXXBoolLiteralExpr>(expr)) {
       return valueBuilder.boolLiteral(literal->getValue());
@@ -38,11 +40,12 @@ public:
 
     if (expr->isKnownToHaveBooleanValue()) {
       bool result;
+      ASTContextLock lock;
       expr->EvaluateAsBooleanCondition(result, astContext);
       return valueBuilder.boolLiteral(result);
     }
 
-    llvm::outs() << "unable to symbolize expression (bool): treating as unknown\n";
+    Log::outs() << "unable to symbolize expression (bool): treating as unknown\n";
     return valueBuilder.unknown();
   }
 
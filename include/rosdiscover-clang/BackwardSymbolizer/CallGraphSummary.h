@@ -0,0 +1,87 @@
+#pragma once
+
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <llvm/Support/raw_ostream.h>
+
+namespace rosdiscover {
+
+/**
+ * The parts of a call graph that are needed to determine which functions are architecturally
+ * relevant. Functions are identified by their USR, which allows the summaries of separately
+ * analyzed translation units to be linked together.
+ */
+class CallGraphSummary {
+public:
+  /** Records that a given function directly calls the ROS API. */
+  void addApiCallFunction(std::string const &function) {
+    apiCallFunctions.insert(function);
+  }
+
+  /** Records that a given function (transitively) depends on another function. */
+  void addCaller(std::string const &callee, std::string const &caller) {
+    functionToCallers[callee].insert(caller);
+  }
+
+  /** Records the qualified name of a function. */
+  void addName(std::string const &function, std::string const &qualifiedName) {
+    functionToName.emplace(function, qualifiedName);
+  }
+
+  /** Returns the qualified name of a given function. */
+  std::string getName(std::string const &function) const {
+    auto it = functionToName.find(function);
+    return it == functionToName.end() ? function : it->second;
+  }
+
+  /** Adds the contents of another summary to this one. */
+  void link(CallGraphSummary const &other) {
+    apiCallFunctions.insert(other.apiCallFunctions.begin(), other.apiCallFunctions.end());
+    for (auto const &entry : other.functionToCallers) {
+      functionToCallers[entry.first].insert(entry.second.begin(), entry.second.end());
+    }
+    functionToName.insert(other.functionToName.begin(), other.functionToName.end());
+  }
+
+  /** Computes the set of functions that (transitively) call the ROS API. */
+  std::unordered_set<std::string> findRelevantFunctions() const {
+    std::unordered_set<std::string> relevantFunctions;
+    std::queue<std::string> queue;
+    for (auto const &function : apiCallFunctions) {
+      queue.push(function);
+    }
+
+    while (!queue.empty()) {
+      auto function = queue.front();
+      queue.pop();
+      if (!relevantFunctions.insert(function).second) {
+        continue;
+      }
+
+      auto it = functionToCallers.find(function);
+      if (it == functionToCallers.end()) {
+        continue;
+      }
+      for (auto const &caller : it->second) {
+        if (relevantFunctions.find(caller) == relevantFunctions.end()) {
+          queue.push(caller);
+        }
+      }
+    }
+
+    for (auto const &function : relevantFunctions) {
+      llvm::outs() << "found relevant function: " << getName(function) << "\n";
+    }
+    return relevantFunctions;
+  }
+
+private:
+  std::unordered_set<std::string> apiCallFunctions;
+  std::unordered_map<std::string, std::unordered_set<std::string>> functionToCallers;
+  std::unordered_map<std::string, std::string> functionToName;
+};
+
+} // rosdiscover
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <clang/AST/ASTContext.h>
+#include <clang/AST/Decl.h>
+#include <clang/AST/DeclCXX.h>
+#include <clang/AST/Expr.h>
+#include <clang/AST/ExprCXX.h>
+#include <clang/AST/RecursiveASTVisitor.h>
+#include <llvm/ADT/DenseSet.h>
+
+#include "../Helper/FileClassifier.h"
+#include "CompactCallGraph.h"
+
+namespace rosdiscover {
+
+/**
+ * Records the direct calls between the functions that are defined in the analyzed files of an
+ * AST. Decls in system headers, in the ROS language bindings, and outside of the paths that the
+ * analysis is restricted to are skipped along with their entire subtree, so no call edges are
+ * collected for unrelated header code. Like clang::CallGraph, calls within lambdas are attributed
+ * to the enclosing function, and dependent (i.e., uninstantiated template) functions are ignored.
+ */
+class CallerIndex : public clang::RecursiveASTVisitor<CallerIndex> {
+public:
+  static std::unique_ptr<CallerIndex> build(clang::ASTContext &context, FileClassifier &fileClassifier) {
+    std::unique_ptr<CallerIndex> index(new CallerIndex(context, fileClassifier));
+    index->TraverseAST(context);
+    return index;
+  }
+
+  /** Returns each call as a (callee, caller) edge between canonical decls. */
+  std::vector<CompactCallGraph::Edge> const & getEdges() const {
+    return edges;
+  }
+
+  /** Returns the canonical decls of all functions that are defined in, or called from, the analyzed files. */
+  std::vector<clang::FunctionDecl const *> const & getFunctions() const {
+    return functions;
+  }
+
+  bool TraverseDecl(clang::Decl *decl) {
+    if (
+         decl == nullptr
+      || clang::isa<clang::TranslationUnitDecl>(decl)
+      || clang::isa<clang::NamespaceDecl>(decl)
+      || clang::isa<clang::LinkageSpecDecl>(decl)
+    ) {
+      return clang::RecursiveASTVisitor<CallerIndex>::TraverseDecl(decl);
+    }
+    if (!isAnalyzed(decl->getLocation())) {
+      return true;
+    }
+
+    auto *function = clang::dyn_cast<clang::FunctionDecl>(decl);
+    if (function == nullptr || !function->doesThisDeclarationHaveABody() || function->isDependentContext()) {
+      return clang::RecursiveASTVisitor<CallerIndex>::TraverseDecl(decl);
+    }
+
+    addFunction(function);
+    auto const *enclosingFunction = currentFunction;
+    currentFunction = function->getCanonicalDecl();
+    bool result = clang::RecursiveASTVisitor<CallerIndex>::TraverseDecl(decl);
+    currentFunction = enclosingFunction;
+    return result;
+  }
+
+  bool shouldVisitTemplateInstantiations() const { return true; }
+
+  bool VisitCallExpr(clang::CallExpr *call) {
+    addCall(call->getDirectCallee());
+    return true;
+  }
+
+  bool VisitCXXConstructExpr(clang::CXXConstructExpr *call) {
+    addCall(call->getConstructor());
+    return true;
+  }
+
+private:
+  clang::SourceManager const &sourceManager;
+  FileClassifier &fileClassifier;
+  clang::FunctionDecl const *currentFunction;
+  std::vector<CompactCallGraph::Edge> edges;
+  std::vector<clang::FunctionDecl const *> functions;
+  llvm::DenseSet<clang::FunctionDecl const *> knownFunctions;
+
+  CallerIndex(clang::ASTContext &context, FileClassifier &fileClassifier)
+    : sourceManager(context.getSourceManager()),
+      fileClassifier(fileClassifier),
+      currentFunction(nullptr),
+      edges(),
+      functions(),
+      knownFunctions()
+  {}
+
+  bool isAnalyzed(clang::SourceLocation location) {
+    if (location.isValid() && sourceManager.isInSystemHeader(location)) {
+      return false;
+    }
+    return fileClassifier.classify(sourceManager, location) == FileKind::Allowed;
+  }
+
+  clang::FunctionDecl const * addFunction(clang::FunctionDecl const *function) {
+    function = function->getCanonicalDecl();
+    if (knownFunctions.insert(function).second) {
+      functions.push_back(function);
+    }
+    return function;
+  }
+
+  void addCall(clang::FunctionDecl const *callee) {
+    if (callee == nullptr || currentFunction == nullptr) {
+      return;
+    }
+    edges.emplace_back(addFunction(callee), currentFunction);
+  }
+};
+
+} // rosdiscover
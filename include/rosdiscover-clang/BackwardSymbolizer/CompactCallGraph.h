@@ -0,0 +1,120 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include <clang/AST/Decl.h>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/BitVector.h>
+#include <llvm/ADT/DenseMap.h>
+
+namespace rosdiscover {
+
+/**
+ * An immutable, compact view of the callers of each function in a call graph.
+ *
+ * Each function (identified by its canonical decl) is assigned a dense index, and the callers of
+ * all functions are stored in a single array in compressed sparse row form: the callers of the
+ * function with index i are found at [offsets[i], offsets[i + 1]). This makes the computation of
+ * transitive callers a walk over two flat arrays, using a bit vector to track visited functions.
+ */
+class CompactCallGraph {
+public:
+  using Edge = std::pair<clang::FunctionDecl const *, clang::FunctionDecl const *>;
+
+  /**
+   * Builds the graph from a list of (callee, caller) edges. Besides calls, edges may describe
+   * other dependencies (e.g., of a callback on the function that registers it).
+   */
+  CompactCallGraph(std::vector<Edge> const &calls, std::vector<Edge> const &extraEdges = {})
+    : functions(), functionToIndex(), offsets(), callers()
+  {
+    // pairs of callee and caller indices
+    std::vector<std::pair<unsigned, unsigned>> edges;
+    edges.reserve(calls.size() + extraEdges.size());
+    for (auto const *edgeList : {&calls, &extraEdges}) {
+      for (auto const &edge : *edgeList) {
+        edges.emplace_back(addFunction(edge.first), addFunction(edge.second));
+      }
+    }
+
+    // a counting sort of the edges by callee
+    offsets.assign(functions.size() + 1, 0);
+    for (auto const &edge : edges) {
+      ++offsets[edge.first + 1];
+    }
+    for (size_t i = 1; i < offsets.size(); ++i) {
+      offsets[i] += offsets[i - 1];
+    }
+    callers.resize(edges.size());
+    std::vector<unsigned> next(offsets.begin(), offsets.end() - 1);
+    for (auto const &edge : edges) {
+      callers[next[edge.first]++] = edge.second;
+    }
+  }
+
+  size_t size() const {
+    return functions.size();
+  }
+
+  /** Returns the canonical decl of the function with a given index. */
+  clang::FunctionDecl const * getFunction(unsigned index) const {
+    return functions[index];
+  }
+
+  /** Returns the index of a given function, or -1 if it isn't part of this graph. */
+  int getIndex(clang::FunctionDecl const *function) const {
+    auto it = functionToIndex.find(function->getCanonicalDecl());
+    return it == functionToIndex.end() ? -1 : static_cast<int>(it->second);
+  }
+
+  /** Returns the indices of the direct callers of the function with a given index. */
+  llvm::ArrayRef<unsigned> getCallers(unsigned index) const {
+    return llvm::makeArrayRef(callers).slice(offsets[index], offsets[index + 1] - offsets[index]);
+  }
+
+  /**
+   * Computes the set of functions that transitively call any of the given functions, including
+   * the given functions themselves. The result is indexed by function index.
+   */
+  llvm::BitVector findTransitiveCallers(llvm::ArrayRef<clang::FunctionDecl const *> targets) const {
+    llvm::BitVector reached(functions.size());
+    std::vector<unsigned> worklist;
+    for (auto const *target : targets) {
+      auto index = getIndex(target);
+      if (index >= 0 && !reached.test(index)) {
+        reached.set(index);
+        worklist.push_back(index);
+      }
+    }
+
+    while (!worklist.empty()) {
+      auto index = worklist.back();
+      worklist.pop_back();
+      for (auto caller : getCallers(index)) {
+        if (!reached.test(caller)) {
+          reached.set(caller);
+          worklist.push_back(caller);
+        }
+      }
+    }
+    return reached;
+  }
+
+private:
+  std::vector<clang::FunctionDecl const *> functions;
+  llvm::DenseMap<clang::FunctionDecl const *, unsigned> functionToIndex;
+  std::vector<unsigned> offsets;
+  std::vector<unsigned> callers;
+
+  unsigned addFunction(clang::FunctionDecl const *function) {
+    function = function->getCanonicalDecl();
+    auto result = functionToIndex.try_emplace(function, functions.size());
+    if (result.second) {
+      functions.push_back(function);
+    }
+    return result.first->second;
+  }
+};
+
+} // rosdiscover
@@ -7,10 +7,12 @@
 #include <clang/AST/ExprCXX.h>
 #include <llvm/ADT/APInt.h>
 
+#include "../Helper/ASTContextLock.h"
+#include "../Helper/Log.h"
 #include "../Builder/ValueBuilder.h"
 #include "../Value/String.h"
 #include "../Value/Value.h"
-#include "../Helper/FindDefVisitor.h"
+#include "../Helper/ReachingDefinitions.h"
 #include "../ApiCall/Calls/Util.h"
 
 #include "../Ast/Stmt/Exprs.h"
@@ -25,27 +27,28 @@ class ExprSymbolizer {
 public:
   ExprSymbolizer(
     clang::ASTContext &astContext,
-    std::unordered_map<clang::Expr const *, SymbolicVariable *> &apiCallToVar
+    std::unordered_map<clang::Expr const *, SymbolicVariable *> &apiCallToVar,
+    ReachingDefinitions &reachingDefinitions
   ): 
     astContext(astContext), 
     valueBuilder(), 
     intSymbolizer(astContext),
     boolSymbolizer(astContext),
     floatSymbolizer(astContext),
-    stringSymbolizer(astContext, apiCallToVar)
+    stringSymbolizer(astContext, apiCallToVar, reachingDefinitions)
   {}
 
   std::unique_ptr<SymbolicExpr> symbolize(const clang::Expr *expr) {
     if (expr == nullptr) {
-      llvm::outs() << "ERROR! Symbolizing (expr): NULLPTR";
+      Log::outs() << "ERROR! Symbolizing (expr): NULLPTR";
       return valueBuilder.unknown();
     }
 
     expr = expr->IgnoreParenCasts()->IgnoreImpCasts()->IgnoreCasts();
 
-    llvm::outs() << "symbolizing (expr): ";
-    expr->dump();
-    llvm::outs() << "\n";
+    Log::outs() << "symbolizing (expr): ";
+    expr->dump(Log::outs(), astContext);
+    Log::outs() << "\n";
 
     if (auto *binOpExpr = clang::dyn_cast<clang::BinaryOperator>(expr)) {
       return symbolizeBinaryOp(binOpExpr);
@@ -77,7 +80,7 @@ public:
     } else if (operatorCallExpr->getOperator() == clang::OO_Exclaim) {
       return std::make_unique<NegateExpr>(symbolize(operatorCallExpr->getArg(0)));
     }
-    llvm::outs() << "unable to symbolize expression (expr): treating as unknown\n";
+    Log::outs() << "unable to symbolize expression (expr): treating as unknown\n";
     return valueBuilder.unknown();
   }
   
@@ -117,24 +120,24 @@ public:
       case SymbolicValueType::Integer:
         return intSymbolizer.symbolize(expr);
       case SymbolicValueType::NodeHandle: 
-        llvm::outs() << "unable to symbolize expression (expr) Node Handle not supported: treating as unknown\n";
-        expr->dump();
+        Log::outs() << "unable to symbolize expression (expr) Node Handle not supported: treating as unknown\n";
+        expr->dump(Log::outs(), astContext);
         return valueBuilder.unknown();
       case SymbolicValueType::Unsupported:
         auto *constNum = api_call::evaluateNumber("ExprSymbolizer", expr, astContext, false);
         if (constNum != nullptr) {
           return std::make_unique<SymbolicConstant>(*constNum);
         }
-        llvm::outs() << "unable to symbolize expression (expr) not supported: treating as unknown\n";
-        expr->dump();
+        Log::outs() << "unable to symbolize expression (expr) not supported: treating as unknown\n";
+        expr->dump(Log::outs(), astContext);
         return valueBuilder.unknown();
     }
   }
 
   std::unique_ptr<SymbolicExpr> symbolizeDeclRef(const clang::DeclRefExpr *declRefExpr) {
     if (declRefExpr->getDecl() == nullptr)  {
-      llvm::outs() << "unable to symbolize expression (expr) since decl wasn't found: treating as unknown\n";
-      declRefExpr->dump();
+      Log::outs() << "unable to symbolize expression (expr) since decl wasn't found: treating as unknown\n";
+      declRefExpr->dump(Log::outs(), astContext);
       return valueBuilder.unknown();
     }
 
@@ -146,6 +149,7 @@ public:
     } else if (auto *enumDecl = clang::dyn_cast<clang::EnumConstantDecl>(decl)) {
       clang::Expr::EvalResult resultInt;
       long enumValue = -1;
+      ASTContextLock lock;
       if (!declRefExpr->isValueDependent() && declRefExpr->EvaluateAsInt(resultInt, astContext)) {
         enumValue = resultInt.Val.getInt().getSExtValue();
       }
@@ -158,15 +162,15 @@ public:
   std::unique_ptr<SymbolicExpr> symbolizeCallExpr(const clang::CallExpr *callExpr) {
     auto funcDecl = callExpr->getDirectCallee();
     if (funcDecl == nullptr) {
-      llvm::outs() << "unable to symbolize expression (expr) since func decl wasn't found: treating as unknown\n";
-      callExpr->dump();
+      Log::outs() << "unable to symbolize expression (expr) since func decl wasn't found: treating as unknown\n";
+      callExpr->dump(Log::outs(), astContext);
       return valueBuilder.unknown();
     }
     if (funcDecl->getQualifiedNameAsString() == "ros::ok") {
       return std::make_unique<BoolLiteral>(true);
     }
-    llvm::outs() << "unable to symbolize expression (expr) due to unknown call name: treating as unknown\n";
-    callExpr->dump();
+    Log::outs() << "unable to symbolize expression (expr) due to unknown call name: treating as unknown\n";
+    callExpr->dump(Log::outs(), astContext);
     return valueBuilder.unknown();
   }
 
@@ -208,7 +212,7 @@ public:
         );
 
       default: 
-        llvm::outs() << "Unsupported binar operator: " << binOpExpr->getOpcode() << " in expr: " << prettyPrint(binOpExpr, astContext) << "\n";
+        Log::outs() << "Unsupported binar operator: " << binOpExpr->getOpcode() << " in expr: " << prettyPrint(binOpExpr, astContext) << "\n";
         return valueBuilder.unknown();
     }
   }
@@ -222,7 +226,7 @@ public:
       case clang::UnaryOperator::Opcode::UO_Not:
         return symbolizeConstant(unaryOpExr);
       default: 
-        llvm::outs() << "Unsupported unary operator: " << unaryOpExr->getOpcode() << " in expr: " << prettyPrint(unaryOpExr, astContext) << "\n";
+        Log::outs() << "Unsupported unary operator: " << unaryOpExr->getOpcode() << " in expr: " << prettyPrint(unaryOpExr, astContext) << "\n";
         return valueBuilder.unknown();
     }
   }
@@ -7,9 +7,11 @@
 #include <clang/AST/ExprCXX.h>
 #include <clang/AST/APValue.h>
 
+#include "../Helper/ASTContextLock.h"
+#include "../Helper/Log.h"
 #include "../Builder/ValueBuilder.h"
 #include "../Value/Float.h"
-#include "../Helper/FindDefVisitor.h"
+#include "../Helper/ReachingDefinitions.h"
 
 namespace rosdiscover {
 
@@ -21,15 +23,15 @@ public:
   std::unique_ptr<SymbolicFloat> symbolize(const clang::Expr *expr) {
 
     if (expr == nullptr) {
-      llvm::outs() << "ERROR! Symbolizing (float): NULLPTR";
+      Log::outs() << "ERROR! Symbolizing (float): NULLPTR";
       return valueBuilder.unknown();
     }
 
     expr = expr->IgnoreParenCasts();
 
-    llvm::outs() << "symbolizing (float): ";
-    expr->dump();
-    llvm::outs() << "\n";
+    Log::outs() << "symbolizing (float): ";
+    expr->dump(Log::outs(), astContext);
+    Log::outs() << "\n";
 
     if (auto *literal = clang::dyn_cast<clang::FloatingLiteral>(expr)) {
       return symbolize(literal);
@@ -37,18 +39,23 @@ public:
 
     //Try evaluating the frequency as float.
     llvm::APFloat resultFloat(0.0);
-    if (expr->EvaluateAsFloat(resultFloat, astContext)) {
-      llvm::outs() << "DEBUG [FloatSymbolizer]: evaluated Float: (" << resultFloat.convertToDouble() << ")\n";
+    bool isEvaluated;
+    {
+      ASTContextLock lock;
+      isEvaluated = expr->EvaluateAsFloat(resultFloat, astContext);
+    }
+    if (isEvaluated) {
+      Log::outs() << "DEBUG [FloatSymbolizer]: evaluated Float: (" << resultFloat.convertToDouble() << ")\n";
       return valueBuilder.floatingLiteral(resultFloat.convertToDouble());
     }
 
-    llvm::outs() << "unable to symbolize expression (float): " << prettyPrint(expr, astContext) << ". treating as unknown\n";
+    Log::outs() << "unable to symbolize expression (float): " << prettyPrint(expr, astContext) << ". treating as unknown\n";
     return valueBuilder.unknown();
   }
   
   std::unique_ptr<SymbolicFloat> symbolize(const clang::APValue *literal) {
     if (literal == nullptr) {
-      llvm::outs() << "unable to symbolize value: treating as unknown\n";
+      Log::outs() << "unable to symbolize value: treating as unknown\n";
       return valueBuilder.unknown();
     }
 
@@ -58,7 +65,7 @@ public:
     } else if (literal->isInt()) {
       return valueBuilder.floatingLiteral(literal->getInt().getSExtValue());
     } else {
-      llvm::outs() << "unable to symbolize value: treating as unknown\n";
+      Log::outs() << "unable to symbolize value: treating as unknown\n";
       return valueBuilder.unknown();
     }
   }
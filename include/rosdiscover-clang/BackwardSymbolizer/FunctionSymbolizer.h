@@ -10,22 +10,26 @@
 #include <clang/AST/DeclCXX.h>
 #include <clang/Analysis/CFG.h>
 #include <clang/Analysis/Analyses/Dominators.h>
-#include <clang/Analysis/Analyses/CFGReachabilityAnalysis.h>
 #include <clang/Analysis/CFGStmtMap.h>
 #include <clang/AST/ParentMap.h>
 #include <llvm/ADT/STLExtras.h>
 #include <fmt/core.h>
 
+#include "../Helper/Log.h"
 #include "../ApiCall/Calls/Util.h"
 #include "../Ast/Ast.h"
 #include "../Ast/Stmt/SymbolicAssignment.h"
 #include "../Ast/Assign/AssignVisitor.h"
 #include "../Ast/Stmt/ControlDependency.h"
+#include "../Helper/MemberInitializerIndex.h"
 #include "../Helper/StmtOrderingVisitor.h"
+#include "../Helper/StmtParentIndex.h"
 #include "../RawStatement.h"
 #include "../Value/String.h"
 #include "../Value/Value.h"
 #include "../Cfg/ControlDependenceGraph.h"
+#include "../Cfg/FunctionCFGAnalysis.h"
+#include "NodeHandleCache.h"
 #include "StringSymbolizer.h"
 #include "IntSymbolizer.h"
 #include "BoolSymbolizer.h"
@@ -43,18 +47,21 @@ public:
       clang::FunctionDecl const *function,
       std::vector<api_call::RosApiCall *> &apiCalls,
       std::vector<clang::Expr *> &functionCalls,
-      std::vector<Callback*> &callbacks
+      std::vector<Callback*> &callbacks,
+      NodeHandleCache &nodeHandleCache,
+      MemberInitializerIndex &memberInitializers,
+      StmtParentIndex &parentIndex
   ) {
     /*
     std::unordered_map<const clang::ParmVarDecl *, std::string> declToArgName;
-    llvm::outs() << "DEBUG: building parameter map\n";
+    Log::outs() << "DEBUG: building parameter map\n";
     for (auto it = symFunction.params_begin(); it != symFunction.params_end(); it++) {
       const clang::ParmVarDecl *parmVarDecl = clang::dyn_cast<clang::ParmVarDecl>(
         function->getParamDecl(it->second.getIndex())->getCanonicalDecl()
       );
-      llvm::outs() << "DEBUG: Added ParmVarDecl mapping [" << it->second.getName() << "]: ";
-      parmVarDecl->dumpColor();
-      llvm::outs() << "\n";
+      Log::outs() << "DEBUG: Added ParmVarDecl mapping [" << it->second.getName() << "]: ";
+      parmVarDecl->dump(Log::outs());
+      Log::outs() << "\n";
       declToArgName.emplace(parmVarDecl, it->second.getName());
     }
     */
@@ -71,7 +78,10 @@ public:
         apiCalls,
         functionCalls,
         symbolicArgNames,
-        callbacks
+        callbacks,
+        nodeHandleCache,
+        memberInitializers,
+        parentIndex
         // declToArgName
     ).run();
   }
@@ -85,7 +95,10 @@ private:
       std::vector<api_call::RosApiCall *> &apiCalls,
       std::vector<clang::Expr *> &functionCalls,
       std::unordered_set<std::string> &symbolicArgNames,
-      std::vector<Callback*> &callbacks
+      std::vector<Callback*> &callbacks,
+      NodeHandleCache &nodeHandleCache,
+      MemberInitializerIndex &memberInitializers,
+      StmtParentIndex &parentIndex
 //      std::unordered_map<const clang::ParmVarDecl *, std::string> &declToArgName
   ) : astContext(astContext),
       symContext(symContext),
@@ -94,18 +107,26 @@ private:
       apiCalls(apiCalls),
       functionCalls(functionCalls),
       apiCallToVar(),
-      stringSymbolizer(astContext, apiCallToVar),
+      reachingDefinitions(astContext),
+      stringSymbolizer(astContext, apiCallToVar, reachingDefinitions),
       intSymbolizer(astContext),
       floatSymbolizer(astContext),
       boolSymbolizer(astContext),
-      exprSymbolizer(astContext, apiCallToVar),
-      assignments(FindVarAssignVisitor::findAssignments(astContext, apiCallToVar, function)),
+      exprSymbolizer(astContext, apiCallToVar, reachingDefinitions),
+      assignments(FindVarAssignVisitor::findAssignments(function)),
       ifMap(),
       whileMap(),
       compoundMap(),
       valueBuilder(),
       symbolicArgNames(symbolicArgNames),
-      callbacks(callbacks)
+      callbacks(callbacks),
+      cfgAnalysis(function, astContext),
+      nodeHandleCache(nodeHandleCache),
+      fieldNodeHandles(),
+      definitionNodeHandles(),
+      usesFunctionContext(false),
+      memberInitializers(memberInitializers),
+      parentIndex(parentIndex)
 //      declToArgName(declToArgName)
   {}
 
@@ -116,31 +137,43 @@ private:
   std::vector<api_call::RosApiCall *> &apiCalls;
   std::vector<clang::Expr *> &functionCalls;
   std::unordered_map<clang::Expr const *, SymbolicVariable *> apiCallToVar;
+  // the definitions of the local variables that reach each statement of the function
+  ReachingDefinitions reachingDefinitions;
   StringSymbolizer stringSymbolizer;
   IntSymbolizer intSymbolizer;
   FloatSymbolizer floatSymbolizer;
   BoolSymbolizer boolSymbolizer;
   ExprSymbolizer exprSymbolizer;
   std::vector<const clang::BinaryOperator*> assignments;
-  std::unordered_map<long, RawIfStatement*> ifMap; //keys are the IDs of the corresponding clang stmts.
-  std::unordered_map<long, RawWhileStatement*> whileMap; //keys are the IDs of the corresponding clang stmts.
+  std::unordered_map<clang::IfStmt const *, RawIfStatement*> ifMap; //keys are the corresponding clang stmts.
+  std::unordered_map<clang::WhileStmt const *, RawWhileStatement*> whileMap; //keys are the corresponding clang stmts.
   std::unordered_map<long, RawCompound*> compoundMap; //keys are the IDs of the corresponding clang stmts.
   ValueBuilder valueBuilder;
   std::unordered_set<std::string> symbolicArgNames;
   [[maybe_unused]] std::vector<Callback*> &callbacks;
+  // the CFG, dominance analyses, and control dependence graph of the function, shared by all of its statements
+  FunctionCFGAnalysis cfgAnalysis;
+  // resolved node handles, keyed by field and by the reaching definition of a local variable
+  NodeHandleCache &nodeHandleCache;
+  std::unordered_map<clang::FieldDecl const *, std::shared_ptr<SymbolicNodeHandle const>> fieldNodeHandles;
+  std::unordered_map<clang::Expr const *, std::shared_ptr<SymbolicNodeHandle const>> definitionNodeHandles;
+  // set whenever a node handle is resolved in terms of the parameters of this function
+  bool usesFunctionContext;
+  MemberInitializerIndex &memberInitializers;
+  StmtParentIndex &parentIndex;
 //  std::unordered_map<const clang::ParmVarDecl *, std::string> declToArgName;
 
   std::unique_ptr<SymbolicStmt> symbolizeApiCall(api_call::RosApiCall *apiCall) {
     using namespace rosdiscover::api_call;
-    llvm::outs() << "symbolizing ROS API call: ";
-    apiCall->print(llvm::outs());
-    llvm::outs() << "\n";
+    Log::outs() << "symbolizing ROS API call: ";
+    apiCall->print(Log::outs());
+    Log::outs() << "\n";
 
     if (apiCall->hasNodeHandle()) {
-      llvm::outs() << "DEBUG: symbolizing ROS API call with associated node handle...\n";
+      Log::outs() << "DEBUG: symbolizing ROS API call with associated node handle...\n";
       return symbolizeApiCallWithNodeHandle((api_call::NodeHandleRosApiCall*) apiCall);
     } else {
-      llvm::outs() << "DEBUG: symbolizing bare ROS API call\n";
+      Log::outs() << "DEBUG: symbolizing bare ROS API call\n";
       return symbolizeBareApiCall((api_call::BareRosApiCall*) apiCall);
     }
   }
@@ -156,9 +189,9 @@ private:
     } else if (auto const *varDecl = clang::dyn_cast<clang::VarDecl>(decl)) {
       return symbolizeNodeHandle(varDecl, atExpr);
     } else {
-      llvm::errs() << "ERROR: failed to symbolize node handle: ";
-      decl->dumpColor();
-      llvm::errs() << "\n";
+      Log::errs() << "ERROR: failed to symbolize node handle: ";
+      decl->dump(Log::errs());
+      Log::errs() << "\n";
       abort();
     }
   }
@@ -166,9 +199,9 @@ private:
   std::unique_ptr<SymbolicNodeHandle> symbolizeNodeHandle(
     clang::Expr *expr
   ) {
-    llvm::outs() << "symbolizing node handle expr: ";
-    expr->dumpColor();
-    llvm::outs() << "\n";
+    Log::outs() << "symbolizing node handle expr: ";
+    expr->dump(Log::outs(), astContext);
+    Log::outs() << "\n";
 
     if (auto *bindTempExpr = clang::dyn_cast<clang::CXXBindTemporaryExpr>(expr)) {
       return symbolizeNodeHandle(bindTempExpr->getSubExpr());
@@ -197,13 +230,13 @@ private:
     }
 
     if (auto *declRefExpr = clang::dyn_cast<clang::DeclRefExpr>(expr)) {
-      llvm::outs() << "DEBUG: attempting to symbolize node handle DeclRefExpr\n";
+      Log::outs() << "DEBUG: attempting to symbolize node handle DeclRefExpr\n";
       return symbolizeNodeHandle(declRefExpr->getDecl(), declRefExpr);
     }
 
-    llvm::outs() << "WARNING: unable to symbolize node handle expression: ";
-    expr->dumpColor();
-    llvm::outs() << "\n";
+    Log::outs() << "WARNING: unable to symbolize node handle expression: ";
+    expr->dump(Log::outs(), astContext);
+    Log::outs() << "\n";
     return valueBuilder.unknownNodeHandle();
   }
 
@@ -217,22 +250,27 @@ private:
       return symbolizeNodeHandle(expr->getArg(0)->IgnoreParenCasts());
     }
 
+    // a default constructor without any parameters
+    if (constructorDecl->getNumParams() == 0) {
+      return valueBuilder.publicNodeHandle();
+    }
+
     // ros::NodeHandle::NodeHandle(const std::string &ns = std::string(), const M_string &remappings = M_string())
     if (constructorDecl->getParamDecl(0)->getOriginalType().getAsString() == "const std::string &") {
-      llvm::outs()
+      Log::outs()
         << "DEBUG: symbolizing node handle constructor "
         << "[ros::NodeHandle::NodeHandle(const std::string &ns = std::string(), const M_string &remappings = M_string())]\n";
       auto *nameExpr = expr->getArg(0)->IgnoreParenCasts();
 
       // default constructor
       if (clang::isa<clang::CXXDefaultArgExpr>(nameExpr)) {
-        llvm::outs() << "DEBUG: symbolizing default constructor argument\n";
+        Log::outs() << "DEBUG: symbolizing default constructor argument\n";
         return valueBuilder.publicNodeHandle();
       }
 
-      llvm::outs() << "DEBUG: symbolizing non-default argument: ";
-      nameExpr->dumpColor();
-      llvm::outs() << "\n";
+      Log::outs() << "DEBUG: symbolizing non-default argument: ";
+      nameExpr->dump(Log::outs(), astContext);
+      Log::outs() << "\n";
 
       auto name = stringSymbolizer.symbolize(nameExpr);
       return valueBuilder.nodeHandle(std::move(name));
@@ -240,7 +278,7 @@ private:
 
     // ros::NodeHandle::NodeHandle(const NodeHandle &parent, const std::string &ns)
     // ros::NodeHandle::NodeHandle(const NodeHandle &parent, const std::string &ns, const M_string &remappings)
-    llvm::outs()
+    Log::outs()
       << "WARNING: parent node handle constructors are not currently supported\n";
     return valueBuilder.unknownNodeHandle();
   }
@@ -249,61 +287,44 @@ private:
     clang::VarDecl const *decl,
     clang::Expr *atExpr
   ) {
-    llvm::outs() << "symbolizing node handle in var decl: ";
-    decl->dumpColor();
-    llvm::outs() << "\n";
-    auto *def = FindDefVisitor::find(astContext, decl, atExpr);
+    Log::outs() << "symbolizing node handle in var decl: ";
+    decl->dump(Log::outs());
+    Log::outs() << "\n";
+    auto *def = reachingDefinitions.find(decl, atExpr);
+    if (def == nullptr) {
+      Log::outs() << "WARNING: no definition of node handle reaches its use\n";
+      return valueBuilder.unknownNodeHandle();
+    }
     return symbolizeNodeHandle(def);
   }
 
   std::unique_ptr<SymbolicNodeHandle> symbolizeNodeHandle(clang::FieldDecl const *decl) {
-    llvm::outs() << "symbolizing node handle in CXX record field: ";
-    decl->dumpColor();
-    llvm::outs() << "\n";
+    Log::outs() << "symbolizing node handle in CXX record field: ";
+    decl->dump(Log::outs());
+    Log::outs() << "\n";
 
     auto const *recordDecl = clang::dyn_cast<clang::CXXRecordDecl>(decl->getParent());
     if (recordDecl == nullptr) {
-      llvm::errs() << "failed to retrieve associated CXX record\n";
+      Log::errs() << "failed to retrieve associated CXX record\n";
       abort();
     }
 
-    // for now, we assume that the node handle is initialized in the constructor's
-    // initializer list
+    // for now, we assume that the node handle is initialized in the constructors'
+    // initializer lists, or by the field's default member initializer
     auto symbolic = std::unique_ptr<SymbolicNodeHandle>();
 
-    for (auto const *constructorDecl : recordDecl->ctors()) {
-      if (constructorDecl->isCopyOrMoveConstructor())
-        continue;
-
-      auto const *constructorDef = clang::dyn_cast<clang::CXXConstructorDecl>(
-        constructorDecl->getDefinition()
-      );
-
-      if (constructorDef == nullptr) {
-        llvm::errs() << "WARNING: unable to retrieve definition for constructor: ";
-        constructorDef->dumpColor();
-        llvm::errs() << "\n";
-        continue;
-      }
-
-      for (auto const *initDecl : constructorDef->inits()) {
-        if (auto const *initMemberDecl = initDecl->getMember()) {
-          if (initMemberDecl != decl)
-            continue;
+    for (auto *initExpr : memberInitializers.find(decl)) {
+      // FIXME if this doesn't call the NodeHandle constructor, skip to unknown
+      auto *nameExpr = initExpr->IgnoreParenCasts();
+      auto newSymbolic = symbolizeNodeHandle(nameExpr);
 
-          // FIXME if this doesn't call the NodeHandle constructor, skip to unknown
-          auto *nameExpr = initDecl->getInit()->IgnoreParenCasts();
-          auto newSymbolic = symbolizeNodeHandle(nameExpr);
+      // FIXME check for ambiguous definition!
+      // if (symbolic.get() != nullptr && !symbolic.equals(newSymbolic)) {
+      //   Log::outs() << "WARNING: node handle has ambiguous definition; treating as unknown\n";
+      //   return SymbolicNodeHandle::unknown();
+      // }
 
-          // FIXME check for ambiguous definition!
-          // if (symbolic.get() != nullptr && !symbolic.equals(newSymbolic)) {
-          //   llvm::outs() << "WARNING: node handle has ambiguous definition; treating as unknown\n";
-          //   return SymbolicNodeHandle::unknown();
-          // }
-
-          symbolic = std::move(newSymbolic);
-        }
-      }
+      symbolic = std::move(newSymbolic);
     }
 
     // FIXME verbose?
@@ -316,30 +337,88 @@ private:
 
   std::unique_ptr<SymbolicNodeHandle> symbolizeNodeHandle(clang::ParmVarDecl const *decl) {
     auto argName = decl->getNameAsString();
-    llvm::outs() << "DEBUG: symbolizing node handle ParmVarDecl [name: " << argName << "]: ";
-    decl->dumpColor();
-    llvm::outs() << "\n";
+    Log::outs() << "DEBUG: symbolizing node handle ParmVarDecl [name: " << argName << "]: ";
+    decl->dump(Log::outs());
+    Log::outs() << "\n";
 
     if (symbolicArgNames.find(argName) != symbolicArgNames.end()) {
+      usesFunctionContext = true;
       return valueBuilder.arg(argName);
     }
     return valueBuilder.unknownNodeHandle();
   }
 
+  /**
+   * Returns the node handle that is stored in a given decl at a given location. Node handles are
+   * resolved once per field and per reaching definition of a local variable, and are then shared
+   * by all API calls that use them.
+   */
+  std::unique_ptr<SymbolicNodeHandle> getNodeHandle(
+    clang::ValueDecl const *decl,
+    clang::Expr *atExpr
+  ) {
+    std::shared_ptr<SymbolicNodeHandle const> nodeHandle;
+    if (auto const *fieldDecl = clang::dyn_cast<clang::FieldDecl>(decl)) {
+      nodeHandle = getNodeHandle(fieldDecl);
+    } else if (clang::isa<clang::ParmVarDecl>(decl)) {
+      return symbolizeNodeHandle(decl, atExpr);
+    } else if (auto const *varDecl = clang::dyn_cast<clang::VarDecl>(decl)) {
+      auto const *def = reachingDefinitions.find(varDecl, atExpr);
+      if (def == nullptr) {
+        Log::outs() << "WARNING: no definition of node handle reaches its use\n";
+        return valueBuilder.unknownNodeHandle();
+      }
+      auto it = definitionNodeHandles.find(def);
+      if (it == definitionNodeHandles.end()) {
+        it = definitionNodeHandles.emplace(def, symbolizeNodeHandle(varDecl, atExpr)).first;
+      }
+      nodeHandle = it->second;
+    } else {
+      return symbolizeNodeHandle(decl, atExpr);
+    }
+    return std::make_unique<SharedNodeHandle>(nodeHandle);
+  }
+
+  std::shared_ptr<SymbolicNodeHandle const> getNodeHandle(clang::FieldDecl const *decl) {
+    auto it = fieldNodeHandles.find(decl);
+    if (it != fieldNodeHandles.end()) {
+      return it->second;
+    }
+
+    // within a constructor of the record, the fields may be resolved in terms of the
+    // constructor's own API calls, so its results aren't shared with other functions
+    auto const *constructorDecl = clang::dyn_cast<clang::CXXConstructorDecl>(function);
+    bool isShared = constructorDecl == nullptr || constructorDecl->getParent() != decl->getParent();
+
+    std::shared_ptr<SymbolicNodeHandle const> nodeHandle = isShared ? nodeHandleCache.find(decl) : nullptr;
+    if (nodeHandle == nullptr) {
+      bool usedFunctionContext = usesFunctionContext;
+      usesFunctionContext = false;
+      nodeHandle = symbolizeNodeHandle(decl);
+      if (isShared && !usesFunctionContext) {
+        nodeHandleCache.insert(decl, nodeHandle);
+      }
+      usesFunctionContext = usesFunctionContext || usedFunctionContext;
+    } else {
+      Log::outs() << "DEBUG: reusing node handle of field [" << decl->getNameAsString() << "]\n";
+    }
+    fieldNodeHandles.emplace(decl, nodeHandle);
+    return nodeHandle;
+  }
+
   std::unique_ptr<SymbolicStmt> symbolizeApiCallWithNodeHandle(
     api_call::RosApiCallWithNodeHandle *apiCall
   ) {
     using namespace rosdiscover::api_call;
 
     // resolved the associated node handle
-    // TODO: this can be cached for each node handle
     clang::Expr *atExpr = const_cast<clang::Expr*>(apiCall->getExpr());
-    auto nodeHandle = symbolizeNodeHandle(apiCall->getNodeHandleDecl(), atExpr);
-    llvm::outs() << "DEBUG: found symbolic node handle: ";
-    nodeHandle->print(llvm::outs());
-    llvm::outs() << "\n";
+    auto nodeHandle = getNodeHandle(apiCall->getNodeHandleDecl(), atExpr);
+    Log::outs() << "DEBUG: found symbolic node handle: ";
+    nodeHandle->print(Log::outs());
+    Log::outs() << "\n";
 
-    llvm::outs() << "DEBUG: symbolizing API call based on kind...\n";
+    Log::outs() << "DEBUG: symbolizing API call based on kind...\n";
     switch (apiCall->getKind()) {
       case RosApiCallKind::AdvertiseServiceCall:
         return symbolizeApiCall(std::move(nodeHandle), (AdvertiseServiceCall*) apiCall);
@@ -364,9 +443,9 @@ private:
       case RosApiCallKind::MessageFiltersSubscriberCall:
         return symbolizeApiCall(std::move(nodeHandle), (MessageFiltersSubscriberCall*) apiCall);
       default:
-        llvm::errs() << "unrecognized ROS API call with node handle: ";
-        apiCall->print(llvm::outs());
-        llvm::outs() << "\n";
+        Log::errs() << "unrecognized ROS API call with node handle: ";
+        apiCall->print(Log::outs());
+        Log::outs() << "\n";
         abort();
     }
   }
@@ -374,9 +453,9 @@ private:
 
   std::unique_ptr<SymbolicStmt> symbolizeBareApiCall(api_call::BareRosApiCall *apiCall) {
     using namespace rosdiscover::api_call;
-    llvm::outs() << "symbolizing bare ROS API call: ";
-    apiCall->print(llvm::outs());
-    llvm::outs() << "\n";
+    Log::outs() << "symbolizing bare ROS API call: ";
+    apiCall->print(Log::outs());
+    Log::outs() << "\n";
 
     switch (apiCall->getKind()) {
       case RosApiCallKind::BareDeleteParamCall:
@@ -400,9 +479,9 @@ private:
       case RosApiCallKind::RateSleepCall:
         return symbolizeApiCall((RateSleepCall*) apiCall);        
       default:
-        llvm::errs() << "unrecognized bare ROS API call: ";
-        apiCall->print(llvm::outs());
-        llvm::outs() << "\n";
+        Log::errs() << "unrecognized bare ROS API call: ";
+        apiCall->print(Log::outs());
+        Log::outs() << "\n";
         abort();
     }
   }
@@ -415,7 +494,7 @@ private:
     std::unique_ptr<SymbolicNodeHandle> nodeHandle,
     api_call::NamedRosApiCall *apiCall
   ) {
-    llvm::outs() << "DEBUG: symbolizing NodeHandleApiCallName\n";
+    Log::outs() << "DEBUG: symbolizing NodeHandleApiCallName\n";
     auto name = symbolizeApiCallName(apiCall);
 
     // FIXME: since we use unique_ptr, we need to use a separate node handle
@@ -428,7 +507,7 @@ private:
     std::unique_ptr<SymbolicNodeHandle> nodeHandle,
     api_call::AdvertiseServiceCall *apiCall
   ) {
-    llvm::outs() << "DEBUG: symbolizing AdvertiseServiceCall\n";
+    Log::outs() << "DEBUG: symbolizing AdvertiseServiceCall\n";
     auto name = symbolizeNodeHandleApiCallName(std::move(nodeHandle), apiCall);
     auto requestResponseFormatNames = apiCall->getRequestResponseFormatNames();
     auto requestFormatName = std::get<0>(requestResponseFormatNames);
@@ -444,7 +523,7 @@ private:
     std::unique_ptr<SymbolicNodeHandle> nodeHandle,
     api_call::AdvertiseTopicCall *apiCall
   ) {
-    llvm::outs() << "DEBUG: symbolizing AdvertiseTopicCall\n";
+    Log::outs() << "DEBUG: symbolizing AdvertiseTopicCall\n";
     return std::make_unique<Publisher>(
       symbolizeNodeHandleApiCallName(std::move(nodeHandle), apiCall),
       apiCall->getFormatName()
@@ -455,9 +534,9 @@ private:
     std::unique_ptr<SymbolicNodeHandle> nodeHandle,
     api_call::MessageFiltersSubscriberCall *apiCall
   ) {
-    llvm::outs() << "DEBUG: symbolizing call to message_filters::Subscriber\n";
+    Log::outs() << "DEBUG: symbolizing call to message_filters::Subscriber\n";
     auto formatName = apiCall->getFormatName();
-    llvm::outs() << "DEBUG [message_filters::Subscriber]: uses format: " << formatName << "\n";
+    Log::outs() << "DEBUG [message_filters::Subscriber]: uses format: " << formatName << "\n";
 
     auto* callback = apiCall->getCallback(astContext);
     std::unique_ptr<SymbolicFunctionCall> symbolicCallBack;
@@ -474,12 +553,12 @@ private:
   }
 
   std::unique_ptr<SymbolicStmt> symbolizeApiCall(api_call::BareDeleteParamCall *apiCall) {
-    llvm::outs() << "DEBUG: symbolizing BareDeleteParamCall\n";
+    Log::outs() << "DEBUG: symbolizing BareDeleteParamCall\n";
     return std::make_unique<DeleteParam>(symbolizeApiCallName(apiCall));
   }
 
   std::unique_ptr<SymbolicStmt> symbolizeApiCall(api_call::BareGetParamCachedCall *apiCall) {
-    llvm::outs() << "DEBUG: symbolizing BareGetParamCachedCall\n";
+    Log::outs() << "DEBUG: symbolizing BareGetParamCachedCall\n";
     return createAssignment(
       std::make_unique<ReadParam>(symbolizeApiCallName(apiCall)),
       apiCall
@@ -487,7 +566,7 @@ private:
   }
 
   std::unique_ptr<SymbolicStmt> symbolizeApiCall(api_call::BareGetParamCall *apiCall) {
-    llvm::outs() << "DEBUG: symbolizing BareGetParamCall\n";
+    Log::outs() << "DEBUG: symbolizing BareGetParamCall\n";
     return createAssignment(
       std::make_unique<ReadParam>(symbolizeApiCallName(apiCall)),
       apiCall
@@ -495,7 +574,7 @@ private:
   }
 
   std::unique_ptr<SymbolicStmt> symbolizeApiCall(api_call::BareGetParamWithDefaultCall *apiCall) {
-    llvm::outs() << "DEBUG: symbolizing BareGetParamWithDefaultCall\n";
+    Log::outs() << "DEBUG: symbolizing BareGetParamWithDefaultCall\n";
     return createAssignment(
       std::make_unique<ReadParamWithDefault>(symbolizeApiCallName(apiCall), valueBuilder.unknown()),
       apiCall
@@ -504,7 +583,7 @@ private:
 
   std::unique_ptr<SymbolicStmt> symbolizeApiCall(api_call::BareHasParamCall *apiCall) {
     // TODO we know that this is a bool!
-    llvm::outs() << "DEBUG: symbolizing BareHasParamCall\n";
+    Log::outs() << "DEBUG: symbolizing BareHasParamCall\n";
     return createAssignment(
       std::make_unique<HasParam>(symbolizeApiCallName(apiCall)),
       apiCall
@@ -512,7 +591,7 @@ private:
   }
 
   std::unique_ptr<SymbolicStmt> symbolizeApiCall(api_call::BareServiceCall *apiCall) {
-    llvm::outs() << "DEBUG: symbolizing BareServiceCall\n";
+    Log::outs() << "DEBUG: symbolizing BareServiceCall\n";
     return std::make_unique<ServiceCaller>(
       symbolizeApiCallName(apiCall),
       apiCall->getFormatName()
@@ -520,7 +599,7 @@ private:
   }
 
   std::unique_ptr<SymbolicStmt> symbolizeApiCall(api_call::BareSetParamCall *apiCall) {
-    llvm::outs() << "DEBUG: symbolizing BareSetParamCall\n";
+    Log::outs() << "DEBUG: symbolizing BareSetParamCall\n";
     return std::make_unique<WriteParam>(symbolizeApiCallName(apiCall), valueBuilder.unknown());
   }
 
@@ -528,7 +607,7 @@ private:
     std::unique_ptr<SymbolicNodeHandle> nodeHandle,
     api_call::DeleteParamCall *apiCall
   ) {
-    llvm::outs() << "DEBUG: symbolizing DeleteParamCall\n";
+    Log::outs() << "DEBUG: symbolizing DeleteParamCall\n";
     return std::make_unique<DeleteParam>(
       symbolizeNodeHandleApiCallName(std::move(nodeHandle), apiCall)
     );
@@ -538,7 +617,7 @@ private:
     std::unique_ptr<SymbolicNodeHandle> nodeHandle,
     api_call::GetParamCachedCall *apiCall
   ) {
-    llvm::outs() << "DEBUG: symbolizing GetParamCachedCall\n";
+    Log::outs() << "DEBUG: symbolizing GetParamCachedCall\n";
     auto name = symbolizeNodeHandleApiCallName(std::move(nodeHandle), apiCall);
     return createAssignment(
       std::make_unique<ReadParam>(std::move(name)),
@@ -550,7 +629,7 @@ private:
     std::unique_ptr<SymbolicNodeHandle> nodeHandle,
     api_call::GetParamCall *apiCall
   ) {
-    llvm::outs() << "DEBUG: symbolizing GetParamCall\n";
+    Log::outs() << "DEBUG: symbolizing GetParamCall\n";
     auto name = symbolizeNodeHandleApiCallName(std::move(nodeHandle), apiCall);
     return createAssignment(
       std::make_unique<ReadParam>(std::move(name)),
@@ -562,7 +641,7 @@ private:
     std::unique_ptr<SymbolicNodeHandle> nodeHandle,
     api_call::GetParamWithDefaultCall *apiCall
   ) {
-    llvm::outs() << "DEBUG: symbolizing GetParamWithDefaultCall\n";
+    Log::outs() << "DEBUG: symbolizing GetParamWithDefaultCall\n";
     auto name = symbolizeNodeHandleApiCallName(std::move(nodeHandle), apiCall);
     return createAssignment(
       std::make_unique<ReadParamWithDefault>(std::move(name), valueBuilder.unknown()),
@@ -575,7 +654,7 @@ private:
     api_call::HasParamCall *apiCall
   ) {
     // TODO we know that this is a bool!
-    llvm::outs() << "DEBUG: symbolizing HasParamCall\n";
+    Log::outs() << "DEBUG: symbolizing HasParamCall\n";
     auto name = symbolizeNodeHandleApiCallName(std::move(nodeHandle), apiCall);
     return createAssignment(
       std::make_unique<HasParam>(std::move(name)),
@@ -584,7 +663,7 @@ private:
   }
 
   std::unique_ptr<SymbolicStmt> symbolizeApiCall(api_call::RosInitCall *apiCall) {
-    llvm::outs() << "DEBUG: symbolizing RosInitCall\n";
+    Log::outs() << "DEBUG: symbolizing RosInitCall\n";
     return std::make_unique<RosInit>(symbolizeApiCallName(apiCall));
   }
 
@@ -592,7 +671,7 @@ private:
     std::unique_ptr<SymbolicNodeHandle> nodeHandle,
     api_call::ServiceClientCall *apiCall
   ) {
-    llvm::outs() << "DEBUG: symbolizing ServiceClientCall\n";
+    Log::outs() << "DEBUG: symbolizing ServiceClientCall\n";
     return std::make_unique<ServiceCaller>(
       symbolizeNodeHandleApiCallName(std::move(nodeHandle), apiCall),
       apiCall->getFormatName()
@@ -603,7 +682,7 @@ private:
     std::unique_ptr<SymbolicNodeHandle> nodeHandle,
     api_call::SetParamCall *apiCall
   ) {
-    llvm::outs() << "DEBUG: symbolizing SetParamCall\n";
+    Log::outs() << "DEBUG: symbolizing SetParamCall\n";
     return std::make_unique<WriteParam>(
       symbolizeNodeHandleApiCallName(std::move(nodeHandle), apiCall),
       valueBuilder.unknown()
@@ -614,7 +693,7 @@ private:
     std::unique_ptr<SymbolicNodeHandle> nodeHandle,
     api_call::SubscribeTopicCall *apiCall
   ) {
-    llvm::outs() << "DEBUG: symbolizing SubscribeTopicCall\n";
+    Log::outs() << "DEBUG: symbolizing SubscribeTopicCall\n";
     auto* callback = apiCall->getCallback(astContext);
     std::unique_ptr<SymbolicFunctionCall> symbolicCallBack;
     if (callback == nullptr) {
@@ -632,7 +711,7 @@ private:
   std::unique_ptr<SymbolicStmt> symbolizeApiCall(
     api_call::RateSleepCall *apiCall
   ) {
-    llvm::outs() << "DEBUG: symbolizing RateSleepCall\n";
+    Log::outs() << "DEBUG: symbolizing RateSleepCall\n";
     return std::make_unique<RateSleep>(
         floatSymbolizer.symbolize(apiCall->getRate(astContext))
     );    
@@ -641,7 +720,7 @@ private:
   std::unique_ptr<SymbolicStmt> symbolizeApiCall(
     api_call::PublishCall *apiCall
   ) {
-    llvm::outs() << "DEBUG: symbolizing PublishCall\n";
+    Log::outs() << "DEBUG: symbolizing PublishCall\n";
 
     return std::make_unique<Publish>(
         apiCall->getPublisherName(astContext),
@@ -664,9 +743,9 @@ private:
     assert(resultExpr);
     apiCallToVar.emplace(resultExpr, local);
 
-    llvm::outs() << "added expr->result mapping [" << local->getName() << "]:\n";
-    resultExpr->dumpColor();
-    llvm::outs() << "\n";
+    Log::outs() << "added expr->result mapping [" << local->getName() << "]:\n";
+    resultExpr->dump(Log::outs(), astContext);
+    Log::outs() << "\n";
 
     return std::move(stmt);
   }
@@ -677,8 +756,8 @@ private:
     } else if (auto *constructExpr = clang::dyn_cast<clang::CXXConstructExpr>(expr)) {
       return getCallee(constructExpr);
     } else {
-      llvm::errs() << "FATAL ERROR: cannot determine callee from expr:\n";
-      expr->dumpColor();
+      Log::errs() << "FATAL ERROR: cannot determine callee from expr:\n";
+      expr->dump(Log::errs(), astContext);
       abort();
     }
   }
@@ -686,8 +765,8 @@ private:
   clang::FunctionDecl const * getCallee(clang::CallExpr *expr) const {
     auto *decl = expr->getDirectCallee();
     if (decl == nullptr) {
-      llvm::errs() << "FATAL ERROR: failed to obtain direct callee from call expr:\n";
-      expr->dumpColor();
+      Log::errs() << "FATAL ERROR: failed to obtain direct callee from call expr:\n";
+      expr->dump(Log::errs(), astContext);
       abort();
     }
     return decl->getCanonicalDecl();
@@ -698,40 +777,15 @@ private:
   }
 
   std::unique_ptr<SymbolicExpr> getControlDependenciesObjects(const clang::Stmt* stmt) {
-    const std::unique_ptr<clang::CFG> sourceCFG = clang::CFG::buildCFG(
-          function, function->getBody(), &astContext, clang::CFG::BuildOptions());
-    clang::ControlDependencyCalculator cdc(sourceCFG.get());
-    stmt->dump();
-    llvm::outs() << "getControlDependencies: ";
-    std::unique_ptr<clang::ParentMap> PM = std::make_unique<clang::ParentMap>(function->getBody());
-    auto CM = std::unique_ptr<clang::CFGStmtMap>(clang::CFGStmtMap::Build(sourceCFG.get(), PM.get()));
-    auto stmt_block = CM->getBlock(stmt); 
-    stmt_block->dump();
-    auto deps = cdc.getControlDependencies(const_cast<clang::CFGBlock *>(stmt_block));
-    
-    auto analysis = std::make_unique<clang::CFGReverseBlockReachabilityAnalysis>(*(sourceCFG.get()));
-    clang::CFGDominatorTreeImpl<true> postDominatorAnalysis(sourceCFG.get());
-    clang::CFGDominatorTreeImpl<false> dominatorAnalysis(sourceCFG.get());
-
-    for (clang::CFGBlock *block: deps) {
-      block->dump();
-    }
-    auto graph = ControlDependenceGraph::buildGraph(stmt_block, deps, postDominatorAnalysis, dominatorAnalysis, astContext, exprSymbolizer);
-    auto condExpr = graph->getBlock(stmt_block)->getFullConditionExpr(astContext, exprSymbolizer);
-    std::vector<const SymbolicVariableReference*> varRefs = {};
-    for (const SymbolicExpr* child : condExpr->getDescendants()) {
-      if (const auto *varRef = dynamic_cast<const SymbolicVariableReference*>(child)) {
-        varRefs.push_back(varRef);
-        llvm::outs() << "SymbolicVariableReference: ";
-        varRef->print(llvm::outs());
-        llvm::outs() << "\n";
-      }
-    }
-    if(condExpr == nullptr) {
-      condExpr = std::make_unique<BoolLiteral>(true);
+    auto const *stmt_block = cfgAnalysis.getBlock(stmt);
+    if (stmt_block == nullptr) {
+      return std::make_unique<BoolLiteral>(true);
     }
-    llvm::outs() << "\nFullControlCondition: " << condExpr->toString() << "\n";
-    return condExpr;
+
+    // all statements within the same block share its path condition, which the function's
+    // control dependence graph computes only once
+    auto *block = cfgAnalysis.getControlDependenceGraph().getBlock(stmt_block);
+    return block->getFullConditionExpr(astContext, exprSymbolizer);
 
 /*
     for (clang::CFGBlock *block: deps) {
@@ -751,22 +805,22 @@ private:
         if (block == nullptr || block->empty() || block->size() < 1 || block->size() > 1000 || block->getTerminatorStmt() == nullptr )   {
           continue;
         }
-        llvm::outs() << "size " << block->size() << "\n";
-        llvm::outs() << "looking for terminator condition in " << block->getTerminatorStmt()->getStmtClassName() << "\n";
+        Log::outs() << "size " << block->size() << "\n";
+        Log::outs() << "looking for terminator condition in " << block->getTerminatorStmt()->getStmtClassName() << "\n";
 
         const auto *condition = block->getTerminatorCondition();
         if (condition == nullptr) {
-          llvm::outs() << "no terminator condition\n";
+          Log::outs() << "no terminator condition\n";
           continue;
         }
         auto conditionStr = rosdiscover::prettyPrint(condition, astContext);
         if (block->getTerminatorStmt()->getStmtClass() == clang::Stmt::SwitchStmtClass) {
           conditionStr = "switch (" + conditionStr + ")";
-          llvm::outs() << "ERROR: Encountered switch: " << conditionStr << "\n";
+          Log::outs() << "ERROR: Encountered switch: " << conditionStr << "\n";
           abort();
         }
         
-        llvm::outs() << "terminator condition found: " << conditionStr << "\n";
+        Log::outs() << "terminator condition found: " << conditionStr << "\n";
         
         std::vector<std::unique_ptr<SymbolicCall>> functionCalls;
         std::vector<std::unique_ptr<SymbolicVariableReference>> variableReferences;
@@ -782,7 +836,7 @@ private:
           }
         }
 
-        llvm::outs() << "variableReferences and functionCalls created\n";
+        Log::outs() << "variableReferences and functionCalls created\n";
         
         results.push_back(
           std::make_unique<SymbolicControlDependency>(
@@ -793,21 +847,21 @@ private:
           )
         );
 
-        llvm::outs() << "SymbolicControlDependency created\n";
+        Log::outs() << "SymbolicControlDependency created\n";
       } catch (...) {
-        llvm::outs() << "[Error] Failed to create SymbolicControlDependency";
+        Log::outs() << "[Error] Failed to create SymbolicControlDependency";
       }
       prevBlock = block;
     }
 
-    llvm::outs() << "getControlDependenciesObjects end\n";
+    Log::outs() << "getControlDependenciesObjects end\n";
 
     return results;*/
   }
 
   std::unique_ptr<SymbolicStmt> symbolizeFunctionCall(clang::Expr *callExpr) {
     auto *calledFunction = symContext.getDefinition(getCallee(callExpr));
-    llvm::outs() << "DEBUG: symbolizing call to function: " << calledFunction->getName() << "\n";
+    Log::outs() << "DEBUG: symbolizing call to function: " << calledFunction->getName() << "\n";
 
     std::unordered_map<std::string, std::unique_ptr<SymbolicValue>> args;
     for (
@@ -816,9 +870,9 @@ private:
       it++
     ) {
       auto &param = it->second;
-      llvm::outs() << "DEBUG: symbolizing function call parameter: ";
-      param.print(llvm::outs());
-      llvm::outs() << "\n";
+      Log::outs() << "DEBUG: symbolizing function call parameter: ";
+      param.print(Log::outs());
+      Log::outs() << "\n";
 
       // fetch the expression for the associated parameter
       clang::Expr *paramExpr;
@@ -827,9 +881,9 @@ private:
       } else if (auto *functionCallExpr = clang::dyn_cast<clang::CallExpr>(callExpr)) {
         paramExpr = functionCallExpr->getArg(param.getIndex());
       } else {
-        llvm::errs() << "ERROR: unrecognized function call type: ";
-        callExpr->dumpColor();
-        llvm::errs() << "\n";
+        Log::errs() << "ERROR: unrecognized function call type: ";
+        callExpr->dump(Log::errs(), astContext);
+        Log::errs() << "\n";
         abort();
       }
 
@@ -837,31 +891,31 @@ private:
       std::unique_ptr<SymbolicValue> symbolicParam = valueBuilder.unknown();
       switch (param.getType()) {
         case SymbolicValueType::String:
-          llvm::outs() << "DEBUG: attempting to symbolize string param\n";
+          Log::outs() << "DEBUG: attempting to symbolize string param\n";
           symbolicParam = stringSymbolizer.symbolize(paramExpr);
           break;
         // where was the node handle defined?
         case SymbolicValueType::NodeHandle:
-          llvm::outs() << "DEBUG: attempting to symbolize node handle param\n";
+          Log::outs() << "DEBUG: attempting to symbolize node handle param\n";
           symbolicParam = symbolizeNodeHandle(paramExpr->IgnoreParenCasts());
           break;
         case SymbolicValueType::Bool:
-          llvm::errs() << "WARNING: boolean symbolization is currently unsupported\n";
+          Log::errs() << "WARNING: boolean symbolization is currently unsupported\n";
           continue;
         case SymbolicValueType::Integer:
-          llvm::errs() << "WARNING: integer symbolization is currently unsupported\n";
+          Log::errs() << "WARNING: integer symbolization is currently unsupported\n";
           continue;
         case SymbolicValueType::Float:
-          llvm::errs() << "WARNING: float symbolization is currently unsupported\n";
+          Log::errs() << "WARNING: float symbolization is currently unsupported\n";
           continue;          
         case SymbolicValueType::Unsupported:
-          llvm::errs() << "ERROR: attempted to symbolize an unsupported type\n";
+          Log::errs() << "ERROR: attempted to symbolize an unsupported type\n";
           abort();
       }
 
-      llvm::outs() << "DEBUG: symbolic parameter [" << param.getName() << "]: ";
-      symbolicParam->print(llvm::outs());
-      llvm::outs() << "\n";
+      Log::outs() << "DEBUG: symbolic parameter [" << param.getName() << "]: ";
+      symbolicParam->print(Log::outs());
+      Log::outs() << "\n";
 
       // store the symbolic parameter
       args.emplace(param.getName(), std::move(symbolicParam));
@@ -874,9 +928,9 @@ private:
   std::unique_ptr<SymbolicIfStmt> symbolizeIf(RawIfStatement* rawIf) {
     auto *stmt = rawIf->getIfStmt();
 
-    llvm::outs() << "DEBUG: symbolizing if: ";
-    stmt->dump();
-    llvm::outs() << "\n";
+    Log::outs() << "DEBUG: symbolizing if: ";
+    stmt->dump(Log::outs(), astContext);
+    Log::outs() << "\n";
 
     auto value = boolSymbolizer.symbolize(stmt->getCond());
     auto trueBranch = symbolizeCompound(rawIf->getTrueBody());
@@ -892,9 +946,9 @@ private:
       if (symbolicStmt != nullptr) {
         result->append(std::move(symbolicStmt));
       } else {
-        llvm::outs() << "[ERROR] Unable to symboliz statement: ";
-        s->getUnderlyingStmt()->dump();
-        llvm::outs() << "\n";
+        Log::outs() << "[ERROR] Unable to symboliz statement: ";
+        s->getUnderlyingStmt()->dump(Log::outs(), astContext);
+        Log::outs() << "\n";
       }
     }
 
@@ -904,21 +958,21 @@ private:
   std::unique_ptr<SymbolicWhileStmt> symbolizeWhile(RawWhileStatement* rawWhile) {
 
     auto *stmt = rawWhile->getWhileStmt();
-    llvm::outs() << "DEBUG: symbolizing while: ";
-    stmt->dump();
-    llvm::outs() << "\n";
+    Log::outs() << "DEBUG: symbolizing while: ";
+    stmt->dump(Log::outs(), astContext);
+    Log::outs() << "\n";
 
     auto symbolicWhile = std::make_unique<SymbolicWhileStmt>(stmt, boolSymbolizer.symbolize(stmt->getCond()), symbolizeCompound(rawWhile->getBody()));
-    llvm::outs() << "SymbolizedWhile: ";
-    symbolicWhile->print(llvm::outs());
+    Log::outs() << "SymbolizedWhile: ";
+    symbolicWhile->print(Log::outs());
     return symbolicWhile;
   }
 
   std::unique_ptr<SymbolicAssignment> symbolizeAssignment(RawAssignment* assignment) {
     auto *assign = assignment->getBinaryOperator();
-    llvm::outs() << "DEBUG: symbolizing assignment: ";
-    assign->dump();
-    llvm::outs() << "\n";
+    Log::outs() << "DEBUG: symbolizing assignment: ";
+    assign->dump(Log::outs(), astContext);
+    Log::outs() << "\n";
 
     std::string varName;
     std::unique_ptr<SymbolicVariableReference> var;
@@ -930,23 +984,23 @@ private:
 
     if (auto *declRefExpr = clang::dyn_cast<clang::DeclRefExpr>(assign->getLHS()->IgnoreCasts()->IgnoreImpCasts())) {
       varName = declRefExpr->getDecl()->getQualifiedNameAsString();
-      llvm::outs() << "declRefExpr assign: " << varName;
+      Log::outs() << "declRefExpr assign: " << varName;
       auto *varDecl = clang::dyn_cast<clang::VarDecl>(declRefExpr->getDecl());
       if (varDecl == nullptr) {
-        llvm::outs() << "Unsupported LHS of Assignment: ";
-        declRefExpr->dump();
+        Log::outs() << "Unsupported LHS of Assignment: ";
+        declRefExpr->dump(Log::outs(), astContext);
         return nullptr;
       }
       var = std::make_unique<SymbolicVariableReference>(declRefExpr, varDecl, exprSymbolizer.symbolizeConstant(varDecl->getInit()));
       compountOperatorLHS = std::make_unique<SymbolicVariableReference>(declRefExpr, varDecl, exprSymbolizer.symbolizeConstant(varDecl->getInit()));
     } else if (auto *memberExpr = clang::dyn_cast<clang::MemberExpr>(assign->getLHS()->IgnoreCasts()->IgnoreImpCasts())) {
       varName = memberExpr->getMemberDecl()->getQualifiedNameAsString();
-      llvm::outs() << "memberExpr assign: " << varName;
+      Log::outs() << "memberExpr assign: " << varName;
       var = exprSymbolizer.symbolizeMemberExpr(memberExpr);
       compountOperatorLHS = exprSymbolizer.symbolizeMemberExpr(memberExpr);
     } else {
-      llvm::outs() << "[ERROR] Unsupported LHS of Assignment: ";
-      assign->dump();
+      Log::outs() << "[ERROR] Unsupported LHS of Assignment: ";
+      assign->dump(Log::outs(), astContext);
       return nullptr;
     }
 
@@ -962,80 +1016,64 @@ private:
     }
     auto symbolicAssignment = std::make_unique<SymbolicAssignment>(std::move(var), std::move(assignRHS), getControlDependenciesObjects(assign));
     
-    llvm::outs() << "Symbolized Assignment: ";
-    symbolicAssignment->print(llvm::outs());
+    Log::outs() << "Symbolized Assignment: ";
+    symbolicAssignment->print(Log::outs());
     return symbolicAssignment;
   }  
   
   /* 
-  Recursively adds the given statement to the control flow nodes of its parents and returns the highest level control flow parent.
+  Adds the given statement to the control flow nodes of its parents, from the innermost to the outermost, and returns the highest level control flow parent.
   */
-  RawStatement* constructParentControlFlow(clang::DynTypedNode node, RawStatement* raw) {
+  RawStatement* constructParentControlFlow(RawStatement* raw) {
+    auto const *parent = parentIndex.getControlFlowParent(raw->getUnderlyingStmt());
+    for (; parent != nullptr; parent = parentIndex.getControlFlowParent(parent)) {
+      clang::WhileStmt const *whileStmt = clang::dyn_cast<clang::WhileStmt>(parent);
+      if (whileStmt != nullptr) {
+        Log::outs() << "DEBUG FOUND WHILE!!!!";
+
+        //construct RawWhile if not already built
+        if (!whileMap.count(whileStmt)) {
+          whileMap.emplace(whileStmt, new RawWhileStatement(const_cast<clang::WhileStmt*>(whileStmt)));
+        }
 
-    // Stop the recursion if the function level has been reached.
-    clang::FunctionDecl const *functionDecl = node.get<clang::FunctionDecl>();
-    if (functionDecl != nullptr) {
-      return raw;
-    }
-    
-    clang::WhileStmt const *whileStmt = node.get<clang::WhileStmt>();
-    if (whileStmt != nullptr) {
-      llvm::outs() << "DEBUG FOUND WHILE!!!!";
-
-      //construct RawWhile if not already built
-      long whileID = whileStmt->getID(astContext);
-      if (!whileMap.count(whileID)) {
-        std::unique_ptr<RawWhileStatement> rs = std::unique_ptr<RawWhileStatement>(new RawWhileStatement(const_cast<clang::WhileStmt*>(whileStmt)));
-        whileMap.emplace(whileID, new RawWhileStatement(const_cast<clang::WhileStmt*>(whileStmt)));
+        //Add to Body
+        whileMap.at(whileStmt)->getBody()->append(raw);
+        raw = whileMap[whileStmt]; // continue with the parents of the while statement.
       }
 
-      //Add to Body
-      whileMap.at(whileID)->getBody()->append(raw);
-      raw = whileMap[whileID]; // continue recursion with the parents of the while statement.
-    }
-
-    clang::IfStmt const *ifStmt = node.get<clang::IfStmt>();
-    if (ifStmt != nullptr) {
-      llvm::outs() << "DEBUG FOUND IF!!!!";
+      clang::IfStmt const *ifStmt = clang::dyn_cast<clang::IfStmt>(parent);
+      if (ifStmt != nullptr) {
+        Log::outs() << "DEBUG FOUND IF!!!!";
 
-      //construct RawIf if not already built
-      long ifID = ifStmt->getID(astContext);
-      if (!ifMap.count(ifID)) {
-        ifMap.emplace(ifID, new RawIfStatement(const_cast<clang::IfStmt*>(ifStmt)));
-      }
+        //construct RawIf if not already built
+        if (!ifMap.count(ifStmt)) {
+          ifMap.emplace(ifStmt, new RawIfStatement(const_cast<clang::IfStmt*>(ifStmt)));
+        }
 
-      //Add to if or else branch
-      if (ifStmt->getThen() == raw->getUnderlyingStmt() || stmtContainsStmt(ifStmt->getThen(), raw->getUnderlyingStmt())) { 
-        llvm::outs() << "Debug: Add to then";
-        ifMap.at(ifID)->getTrueBody()->append(raw);
-        raw = ifMap[ifID];
-      } else if (ifStmt->getElse() == raw->getUnderlyingStmt() || stmtContainsStmt(ifStmt->getElse(), raw->getUnderlyingStmt())) { 
-        llvm::outs() << "Debug: Add to else";
-        ifMap.at(ifID)->getFalseBody()->append(raw);
-        raw = ifMap[ifID];
-      } else if (ifStmt->getCond() == raw->getUnderlyingStmt() || stmtContainsStmt(ifStmt->getCond(), raw->getUnderlyingStmt())) { 
-        llvm::outs() << "Debug: In condition, treat as outside of if";
-      } else {
-        llvm::outs() << "ERROR: raw is neither in then nor else! Raw: ";
-        raw->getUnderlyingStmt()->dump();
-        llvm::outs() << "\n IfStmt: ";
-        ifStmt->dump();
-        llvm::outs() << "\n";
-        abort();
+        //Add to if or else branch
+        if (ifStmt->getThen() == raw->getUnderlyingStmt() || parentIndex.contains(ifStmt->getThen(), raw->getUnderlyingStmt())) { 
+          Log::outs() << "Debug: Add to then";
+          ifMap.at(ifStmt)->getTrueBody()->append(raw);
+          raw = ifMap[ifStmt];
+        } else if (ifStmt->getElse() == raw->getUnderlyingStmt() || parentIndex.contains(ifStmt->getElse(), raw->getUnderlyingStmt())) { 
+          Log::outs() << "Debug: Add to else";
+          ifMap.at(ifStmt)->getFalseBody()->append(raw);
+          raw = ifMap[ifStmt];
+        } else if (ifStmt->getCond() == raw->getUnderlyingStmt() || parentIndex.contains(ifStmt->getCond(), raw->getUnderlyingStmt())) { 
+          Log::outs() << "Debug: In condition, treat as outside of if";
+        } else {
+          Log::outs() << "ERROR: raw is neither in then nor else! Raw: ";
+          raw->getUnderlyingStmt()->dump(Log::outs(), astContext);
+          Log::outs() << "\n IfStmt: ";
+          ifStmt->dump(Log::outs(), astContext);
+          Log::outs() << "\n";
+          abort();
+        }
+        raw = ifMap[ifStmt];
       }
-      raw = ifMap[ifID];
-    }
-    RawStatement* result = raw;
-    for (clang::DynTypedNode const parent : astContext.getParents(node)) {
-      result = constructParentControlFlow(parent, raw);
     }
 
-    return result;
-  }
-
-  RawStatement* constructParentControlFlow(RawStatement* raw) {
-    auto node = clang::DynTypedNode::create(*(raw->getUnderlyingStmt()));
-    return constructParentControlFlow(node, raw);
+    return raw;
   }
 
   std::vector<RawStatement*> computeStatementOrder() {
@@ -1091,21 +1129,21 @@ private:
   }
 
   std::unique_ptr<SymbolicFunctionCall> symbolizeCallback(RawCallbackStatement *statement) {
-    llvm::outs() << "DEBUG: symbolizing callback\n";
+    Log::outs() << "DEBUG: symbolizing callback\n";
     if (statement == nullptr) {
-      llvm::outs() << "ERROR: callback statement\n";
+      Log::outs() << "ERROR: callback statement\n";
     }
     if (statement->getTargetFunction() == nullptr) {
-      llvm::outs() << "ERROR: no target function\n";
+      Log::outs() << "ERROR: no target function\n";
     }
-    llvm::outs() << "DEBUG: getting definition\n";
+    Log::outs() << "DEBUG: getting definition\n";
     auto *function = symContext.getDefinition(statement->getTargetFunction());
     if (function == nullptr) {
-      llvm::outs() << "ERROR: target function definition not found\n";
+      Log::outs() << "ERROR: target function definition not found\n";
     }
-    llvm::outs() << "DEBUG: target function definition found\n";
+    Log::outs() << "DEBUG: target function definition found\n";
     auto result = SymbolicFunctionCall::create(function);
-    llvm::outs() << "DEBUG: symbolized callback\n";
+    Log::outs() << "DEBUG: symbolized callback\n";
     return result;
   }
 
@@ -1153,13 +1191,13 @@ private:
       if (stmt != nullptr) {
         compound->append(std::move(stmt));
       } else {
-        llvm::outs() << "[ERROR] Unable to symboliz statement: ";
-        rawStmt->getUnderlyingStmt()->dump();
-        llvm::outs() << "\n";
+        Log::outs() << "[ERROR] Unable to symboliz statement: ";
+        rawStmt->getUnderlyingStmt()->dump(Log::outs(), astContext);
+        Log::outs() << "\n";
       }
     }
 
-    llvm::outs() << "Symbolized Function\n";
+    Log::outs() << "Symbolized Function\n";
 
     symContext.define(function, std::move(compound));
   }
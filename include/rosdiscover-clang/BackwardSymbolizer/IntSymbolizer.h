@@ -7,9 +7,11 @@
 #include <clang/AST/ExprCXX.h>
 #include <clang/AST/APValue.h>
 
+#include "../Helper/ASTContextLock.h"
+#include "../Helper/Log.h"
 #include "../Builder/ValueBuilder.h"
 #include "../Value/String.h"
-#include "../Helper/FindDefVisitor.h"
+#include "../Helper/ReachingDefinitions.h"
 
 namespace rosdiscover {
 
@@ -21,15 +23,15 @@ public:
   std::unique_ptr<SymbolicInteger> symbolize(const clang::Expr *expr) {
 
     if (expr == nullptr) {
-      llvm::outs() << "ERROR! Symbolizing (int): NULLPTR";
+      Log::outs() << "ERROR! Symbolizing (int): NULLPTR";
       return valueBuilder.unknown();
     }
 
     expr = expr->IgnoreParenCasts();
 
-    llvm::outs() << "symbolizing (int): ";
-    expr->dump();
-    llvm::outs() << "\n";
+    Log::outs() << "symbolizing (int): ";
+    expr->dump(Log::outs(), astContext);
+    Log::outs() << "\n";
 
     if (auto *literal = clang::dyn_cast<clang::IntegerLiteral>(expr)) {
       return symbolize(literal);
@@ -37,18 +39,23 @@ public:
 
     //Try evaluating the frequency as integer.
     clang::Expr::EvalResult resultInt;
-    if (!expr->isValueDependent() && expr->EvaluateAsInt(resultInt, astContext)) {
-      llvm::outs() << "DEBUG [IntSymbolizer]: evaluated INT: (" << resultInt.Val.getInt().getSExtValue() << ")\n";
+    bool isEvaluated;
+    {
+      ASTContextLock lock;
+      isEvaluated = !expr->isValueDependent() && expr->EvaluateAsInt(resultInt, astContext);
+    }
+    if (isEvaluated) {
+      Log::outs() << "DEBUG [IntSymbolizer]: evaluated INT: (" << resultInt.Val.getInt().getSExtValue() << ")\n";
       return valueBuilder.integerLiteral(resultInt.Val.getInt().getSExtValue());
     }
 
-    llvm::outs() << "unable to symbolize expression (int): treating as unknown\n";
+    Log::outs() << "unable to symbolize expression (int): treating as unknown\n";
     return valueBuilder.unknown();
   }
   
   std::unique_ptr<SymbolicInteger> symbolize(const clang::APValue *literal) {
     if (literal == nullptr) {
-      llvm::outs() << "unable to symbolize value: treating as unknown\n";
+      Log::outs() << "unable to symbolize value: treating as unknown\n";
       return valueBuilder.unknown();
     }
 
@@ -60,7 +67,7 @@ private:
 
   std::unique_ptr<SymbolicInteger> symbolize(const clang::IntegerLiteral *literal) {
     if (literal == nullptr) {
-      llvm::outs() << "unable to symbolize value: treating as unknown\n";
+      Log::outs() << "unable to symbolize value: treating as unknown\n";
       return valueBuilder.unknown();
     }
 
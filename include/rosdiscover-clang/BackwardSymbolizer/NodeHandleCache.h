@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+
+#include <clang/AST/Decl.h>
+#include <llvm/ADT/DenseMap.h>
+
+#include "../Value/Value.h"
+
+namespace rosdiscover {
+
+/**
+ * Holds the node handles that are stored in the fields of CXX records, which are resolved from
+ * the constructors of those records rather than from the function that uses them. A field's node
+ * handle is therefore resolved once and is then shared by all functions that are symbolized from
+ * the same AST, which may be symbolized concurrently.
+ */
+class NodeHandleCache {
+public:
+  NodeHandleCache() : mutex(), fieldNodeHandles() {}
+
+  /** Returns the node handle of a given field, or nullptr if it hasn't been resolved yet. */
+  std::shared_ptr<SymbolicNodeHandle const> find(clang::FieldDecl const *field) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = fieldNodeHandles.find(field);
+    return it == fieldNodeHandles.end() ? nullptr : it->second;
+  }
+
+  void insert(clang::FieldDecl const *field, std::shared_ptr<SymbolicNodeHandle const> nodeHandle) {
+    std::lock_guard<std::mutex> lock(mutex);
+    fieldNodeHandles.try_emplace(field, std::move(nodeHandle));
+  }
+
+private:
+  std::mutex mutex;
+  llvm::DenseMap<clang::FieldDecl const *, std::shared_ptr<SymbolicNodeHandle const>> fieldNodeHandles;
+};
+
+} // rosdiscover
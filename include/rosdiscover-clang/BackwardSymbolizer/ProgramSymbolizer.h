@@ -1,14 +1,32 @@
 #pragma once
 
+#include <algorithm>
 #include <assert.h>
+#include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
 #include <clang/AST/ASTImporter.h>
+#include <clang/AST/ASTImporterLookupTable.h>
+#include <clang/AST/ASTImporterSharedState.h>
+#include <clang/AST/DeclCXX.h>
 #include <clang/Tooling/Tooling.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
 
 #include "../Ast/Program.h"
+#include "../Frontend/ASTBuilder.h"
+#include "../Frontend/ASTCache.h"
+#include "../Frontend/CompileCommands.h"
+#include "../Frontend/RosApiPrefilter.h"
+#include "../Frontend/SharedPreambles.h"
+#include "../Helper/FileClassifier.h"
+#include "../Helper/MemoryUsage.h"
+#include "CallGraphSummary.h"
 #include "Symbolizer.h"
+#include "SymbolizerOptions.h"
 
 namespace rosdiscover {
 
@@ -17,46 +35,336 @@ public:
   static std::unique_ptr<SymbolicProgram> symbolize(
       clang::tooling::CompilationDatabase const &compilationDatabase,
       llvm::ArrayRef<std::string> sourcePaths,
-      std::vector<std::string> &restrictAnalysisToPaths
+      std::vector<std::string> &restrictAnalysisToPaths,
+      SymbolizerOptions const &options = SymbolizerOptions()
   ) {
     auto symbolizer = ProgramSymbolizer(
       compilationDatabase,
       sourcePaths,
-      restrictAnalysisToPaths
+      restrictAnalysisToPaths,
+      options
     );
     symbolizer.run();
     return std::move(symbolizer.program);
   }
 
 private:
-  clang::tooling::ClangTool tool;
+  clang::tooling::CompilationDatabase const &compilationDatabase;
+  std::vector<std::string> sourcePaths;
   std::unique_ptr<SymbolicProgram> program;
+  std::unique_ptr<ASTCache> cache;
+  // the merged AST may read from the shared preambles, so they must be destroyed after it
+  std::unique_ptr<SharedPreambles> preambles;
   std::unique_ptr<clang::ASTUnit> mergedAst;
   std::vector<std::string> &restrictAnalysisToPaths;
+  FileClassifier fileClassifier;
+  SymbolizerOptions options;
 
   ProgramSymbolizer(
       clang::tooling::CompilationDatabase const &compilationDatabase,
       llvm::ArrayRef<std::string> sourcePaths,
-      std::vector<std::string> &restrictAnalysisToPaths
-  ) : tool(compilationDatabase, sourcePaths),
+      std::vector<std::string> &restrictAnalysisToPaths,
+      SymbolizerOptions const &options
+  ) : compilationDatabase(compilationDatabase),
+      sourcePaths(sourcePaths.begin(), sourcePaths.end()),
       program(std::make_unique<SymbolicProgram>()),
-      restrictAnalysisToPaths(restrictAnalysisToPaths)
-  {
-    tool.setDiagnosticConsumer(new clang::IgnoringDiagConsumer());
+      restrictAnalysisToPaths(restrictAnalysisToPaths),
+      fileClassifier(restrictAnalysisToPaths),
+      options(options)
+  {}
+
+  /**
+   * Returns the top-level decls of a given AST. ASTs that were loaded from the AST cache
+   * don't keep track of their top-level decls, so we use the decls of their translation unit.
+   */
+  static std::vector<clang::Decl*> getTopLevelDecls(clang::ASTUnit &unit) {
+    std::vector<clang::Decl*> decls;
+    if (unit.isMainFileAST()) {
+      for (auto *decl : unit.getASTContext().getTranslationUnitDecl()->decls()) {
+        if (!decl->isImplicit()) {
+          decls.push_back(decl);
+        }
+      }
+    } else {
+      decls.insert(decls.end(), unit.top_level_begin(), unit.top_level_end());
+    }
+    return decls;
+  }
+
+  /** Returns the name of the file in which a given decl is located, or an empty string if it has no file. */
+  static std::string getFileName(clang::SourceManager const &sourceManager, clang::Decl const *decl) {
+    auto location = sourceManager.getExpansionLoc(decl->getLocation());
+    if (location.isInvalid()) {
+      return "";
+    }
+    auto const *file = sourceManager.getFileEntryForID(sourceManager.getFileID(location));
+    return file == nullptr ? "" : file->getName().str();
+  }
+
+  /**
+   * Determines whether a top-level decl should be imported into the merged AST.
+   * Decls in the main file of their translation unit, or under the paths that the analysis is
+   * restricted to, are always imported. Decls in any other header are only imported if the merged
+   * AST doesn't contain that header yet, and only if the analysis isn't restricted to certain paths.
+   * Everything else that an imported decl refers to is imported on demand by the ASTImporter.
+   */
+  bool shouldImport(
+      clang::SourceManager const &sourceManager,
+      clang::Decl const *decl,
+      std::set<std::string> const &mergedFiles
+  ) {
+    auto location = sourceManager.getExpansionLoc(decl->getLocation());
+    if (location.isInvalid() || sourceManager.isInMainFile(location)) {
+      return true;
+    }
+
+    if (restrictAnalysisToPaths.empty()) {
+      return mergedFiles.find(getFileName(sourceManager, decl)) == mergedFiles.end();
+    }
+    // the file of each FileID is only matched against the allowed paths once
+    auto kind = fileClassifier.classify(sourceManager, location);
+    if (kind == FileKind::RosInternal) {
+      return fileClassifier.isAllowedPath(getFileName(sourceManager, decl));
+    }
+    return kind == FileKind::Allowed;
+  }
+
+  /**
+   * Finds the namespace, class, or translation unit of the merged AST that corresponds to a given
+   * decl context of another AST, or returns nullptr if the merged AST doesn't contain it.
+   */
+  static clang::DeclContext * findMergedContext(
+      clang::ASTContext &toContext,
+      clang::ASTImporterLookupTable const &lookupTable,
+      clang::DeclContext const *fromContext
+  ) {
+    fromContext = fromContext->getRedeclContext();
+    if (fromContext->isTranslationUnit()) {
+      return toContext.getTranslationUnitDecl();
+    }
+    if (!llvm::isa<clang::NamespaceDecl>(fromContext) && !llvm::isa<clang::CXXRecordDecl>(fromContext)) {
+      return nullptr;
+    }
+    auto const *fromNamedDecl = llvm::cast<clang::NamedDecl>(fromContext);
+    if (fromNamedDecl->getIdentifier() == nullptr) {
+      return nullptr;
+    }
+    auto *toParent = findMergedContext(toContext, lookupTable, fromContext->getParent());
+    if (toParent == nullptr) {
+      return nullptr;
+    }
+
+    clang::DeclarationName name(&toContext.Idents.get(fromNamedDecl->getName()));
+    for (auto *existing : lookupTable.lookup(toParent, name)) {
+      if (existing->getKind() != fromNamedDecl->getKind()) {
+        continue;
+      }
+      if (auto *toNamespace = llvm::dyn_cast<clang::NamespaceDecl>(existing)) {
+        return toNamespace->getPrimaryContext();
+      }
+      if (auto *toRecord = llvm::cast<clang::CXXRecordDecl>(existing)->getDefinition()) {
+        return toRecord;
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * Determines whether the merged AST already contains a definition of a given top-level decl.
+   * Under the one-definition rule, such a decl doesn't need to be imported again, and skipping it
+   * here is much cheaper than letting the ASTImporter check the two definitions for structural
+   * equivalence. The rule only applies to externally visible decls: a static function or a class
+   * in an anonymous namespace may share its name with a different entity in another translation
+   * unit, so those are always imported.
+   */
+  static bool isAlreadyDefined(
+      clang::ASTContext &toContext,
+      clang::ASTImporterLookupTable const &lookupTable,
+      clang::Decl const *fromDecl
+  ) {
+    auto const *namedDecl = llvm::dyn_cast<clang::NamedDecl>(fromDecl);
+    if (namedDecl == nullptr || namedDecl->getIdentifier() == nullptr || !namedDecl->isExternallyVisible()) {
+      return false;
+    }
+
+    auto const *fromFunction = llvm::dyn_cast<clang::FunctionDecl>(fromDecl);
+    if (fromFunction != nullptr && !fromFunction->doesThisDeclarationHaveABody()) {
+      return false;
+    }
+    auto const *fromTag = llvm::dyn_cast<clang::TagDecl>(fromDecl);
+    if (fromTag != nullptr && !fromTag->isThisDeclarationADefinition()) {
+      return false;
+    }
+    auto const *fromTemplate = llvm::dyn_cast<clang::ClassTemplateDecl>(fromDecl);
+    if (fromTemplate != nullptr && !fromTemplate->isThisDeclarationADefinition()) {
+      return false;
+    }
+    if (fromFunction == nullptr && fromTag == nullptr && fromTemplate == nullptr) {
+      return false;
+    }
+
+    // out-of-line definitions (e.g., of methods) are looked up in their semantic context
+    auto *toDeclContext = findMergedContext(toContext, lookupTable, fromDecl->getDeclContext());
+    if (toDeclContext == nullptr) {
+      return false;
+    }
+    clang::DeclarationName name(&toContext.Idents.get(namedDecl->getName()));
+    for (auto *existing : lookupTable.lookup(toDeclContext, name)) {
+      if (existing->getKind() != fromDecl->getKind()) {
+        continue;
+      }
+      if (fromFunction != nullptr) {
+        auto const *toFunction = llvm::cast<clang::FunctionDecl>(existing);
+        if (toFunction->hasBody() && toFunction->getType().getAsString() == fromFunction->getType().getAsString()) {
+          return true;
+        }
+      } else if (fromTag != nullptr) {
+        if (llvm::cast<clang::TagDecl>(existing)->getDefinition() != nullptr) {
+          return true;
+        }
+      } else if (llvm::cast<clang::ClassTemplateDecl>(existing)->getTemplatedDecl()->getDefinition() != nullptr) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /** Finds the compile commands for each source file, in the order that the files were given. */
+  std::vector<clang::tooling::CompileCommand> findCompileCommands() const {
+    std::vector<clang::tooling::CompileCommand> commands;
+    for (auto const &sourcePath : sourcePaths) {
+      llvm::SmallString<256> absolutePath(sourcePath);
+      llvm::sys::fs::make_absolute(absolutePath);
+      llvm::sys::path::remove_dots(absolutePath, /*remove_dot_dot=*/true);
+
+      auto fileCommands = compilationDatabase.getCompileCommands(absolutePath);
+      if (fileCommands.empty()) {
+        llvm::errs() << "WARNING: skipping " << sourcePath << ": compile command not found\n";
+        continue;
+      }
+      commands.insert(commands.end(), fileCommands.begin(), fileCommands.end());
+    }
+    return commands;
+  }
+
+  /**
+   * Finds the compile commands that should be analyzed, and prepares the AST cache and shared
+   * preambles that are used to parse them.
+   */
+  std::vector<clang::tooling::CompileCommand> prepareCompileCommands() {
+    // the same source file may be compiled multiple times for different CMake build targets;
+    // we drop the redundant compile commands here so that each source file is only parsed once
+    auto allCommands = findCompileCommands();
+    auto commands = CompileCommandDeduplicator::deduplicate(allCommands, options.duplicateCommandPolicy);
+    llvm::outs()
+      << "skipped " << allCommands.size() - commands.size()
+      << " of " << allCommands.size() << " compile commands as duplicates\n";
+
+    // translation units that never mention the ROS API can't contribute to the analysis
+    if (options.useRosApiPrefilter) {
+      RosApiPrefilter prefilter;
+      auto relevantCommands = prefilter.filter(commands);
+      llvm::outs()
+        << "prefilter skipped " << commands.size() - relevantCommands.size()
+        << " of " << commands.size() << " compile commands without ROS API usage\n";
+      if (relevantCommands.empty()) {
+        llvm::errs() << "WARNING: no translation unit mentions the ROS API; analyzing all of them\n";
+      } else {
+        commands = std::move(relevantCommands);
+      }
+    }
+
+    if (!options.astCacheDirectory.empty()) {
+      llvm::outs() << "using AST cache directory: " << options.astCacheDirectory << "\n";
+      cache = std::make_unique<ASTCache>(options.astCacheDirectory);
+    }
+    if (options.useSharedPreambles) {
+      // preambles are kept next to the cached ASTs, which may depend on them
+      std::string preambleDirectory;
+      if (!options.astCacheDirectory.empty()) {
+        llvm::SmallString<256> path(options.astCacheDirectory);
+        llvm::sys::path::append(path, "preambles");
+        preambleDirectory = path.str().str();
+      }
+      preambles = std::make_unique<SharedPreambles>(preambleDirectory);
+      preambles->build(commands);
+    }
+    return commands;
+  }
+
+  /** Returns the number of translation units that are parsed concurrently. */
+  unsigned getNumJobs() const {
+    return options.numJobs == 0 ? llvm::hardware_concurrency().compute_thread_count() : options.numJobs;
+  }
+
+  /**
+   * Parses the given compile commands in batches of up to one per job, and passes each AST to a
+   * given function before it is destroyed. At most one batch of ASTs is held in memory at any time.
+   * If a memory limit is given, the size of each batch is chosen so that the estimated memory usage
+   * of its ASTs stays below that limit.
+   */
+  template <typename Function>
+  void forEachAST(std::vector<clang::tooling::CompileCommand> const &commands, Function function) {
+    uint64_t memoryLimit = static_cast<uint64_t>(options.memoryLimitMiB) * 1024 * 1024;
+    size_t maxBatchSize = getNumJobs();
+    // until we know how much memory an AST takes, we parse one at a time when there's a limit
+    size_t batchSize = memoryLimit == 0 ? maxBatchSize : 1;
+    uint64_t bytesPerAst = 0;
+    bool exceededMemoryLimit = false;
+
+    for (size_t start = 0; start < commands.size(); start += batchSize) {
+      auto currentRSS = MemoryUsage::getCurrentRSS();
+      if (memoryLimit != 0 && bytesPerAst != 0) {
+        uint64_t available = memoryLimit > currentRSS ? memoryLimit - currentRSS : 0;
+        batchSize = std::max<size_t>(1, std::min<uint64_t>(maxBatchSize, available / bytesPerAst));
+      }
+
+      std::vector<clang::tooling::CompileCommand> batch(
+        commands.begin() + start,
+        commands.begin() + std::min(start + batchSize, commands.size())
+      );
+      auto asts = ASTBuilder::build(batch, options.numJobs, cache.get(), preambles.get());
+
+      auto batchRSS = MemoryUsage::getCurrentRSS();
+      if (!asts.empty() && batchRSS > currentRSS) {
+        bytesPerAst = std::max<uint64_t>(bytesPerAst, (batchRSS - currentRSS) / asts.size());
+      }
+      if (memoryLimit != 0 && batchRSS > memoryLimit && !exceededMemoryLimit) {
+        exceededMemoryLimit = true;
+        llvm::errs()
+          << "WARNING: memory usage (" << MemoryUsage::toMiB(batchRSS) << " MiB) exceeds the memory limit ("
+          << options.memoryLimitMiB << " MiB) while processing a batch of " << batch.size()
+          << " translation units\n";
+      }
+
+      for (auto &ast : asts) {
+        function(*ast);
+        ast.reset();
+      }
+    }
   }
 
   void buildAST() {
+    auto commands = prepareCompileCommands();
+
     // build the AST for each translation unit
-    llvm::outs() << "building ASTs..\n";
+    llvm::outs()
+      << "building ASTs for " << commands.size() << " compile commands using "
+      << getNumJobs() << " jobs..\n";
+    assert(options.memoryLimitMiB == 0 && "the memory limit is only enforced when using --link-summaries");
     std::vector<std::unique_ptr<clang::ASTUnit>> asts;
-    tool.buildASTs(asts);
+    {
+      PhaseMemoryReporter reporter("parse");
+      asts = ASTBuilder::build(commands, options.numJobs, cache.get(), preambles.get());
+    }
     size_t numAsts = asts.size();
     llvm::outs() << "built " << numAsts << " ASTs\n";
     assert(numAsts > 0);
 
-    // the same source file may be compiled multiple times for different CMake build targets
-    // Clang doesn't know that, so, by default, it will include multiple copies of the same
-    // AST, which results in a failed merging process
+    // duplicate compile commands have already been removed, but the same source file may still
+    // be reached through differently spelled paths (e.g., symlinks). Clang doesn't know that, so
+    // we also drop ASTs that share the same original source file, which would otherwise result
+    // in a failed merging process
     std::set<std::string> representedSourceFiles;
     std::vector<std::unique_ptr<clang::ASTUnit>> deduplicatedAsts;
     for (auto i = 0; i < numAsts; i++) {
@@ -86,50 +394,133 @@ private:
     // - https://clang.llvm.org/docs/LibASTImporter.html
     // - https://clang.llvm.org/docs/InternalsManual.html#the-astimporter
     // - https://github.com/correctcomputation/checkedc-clang/issues/551
+    PhaseMemoryReporter reporter("merge");
     clang::ASTUnit *toUnit = asts[0].get();
+
+    // keeps track of the files whose top-level decls are already part of the merged AST;
+    // most of the time spent merging would otherwise go into re-importing the same headers
+    std::set<std::string> mergedFiles;
+    for (clang::Decl *decl : getTopLevelDecls(*toUnit)) {
+      mergedFiles.insert(getFileName(toUnit->getSourceManager(), decl));
+    }
+
+    // all importers share a single lookup table for the merged AST, which is built once and then
+    // kept up to date as decls are imported, rather than being rebuilt for every translation unit
+    auto sharedState = std::make_shared<clang::ASTImporterSharedState>(
+      *toUnit->getASTContext().getTranslationUnitDecl()
+    );
+
+    size_t numImportedDecls = 0;
+    size_t numSkippedDecls = 0;
+    size_t numExistingDefinitions = 0;
     for (auto i = 1; i < numAsts; ++i) {
       llvm::outs() << "importing decls from translation unit [" << i << "/" << numAsts - 1 << "]\n";
       clang::ASTUnit *fromUnit = asts[i].get();
-      clang::ASTImporter importer(
-        toUnit->getASTContext(),
-        toUnit->getFileManager(),
-        fromUnit->getASTContext(),
-        fromUnit->getFileManager(),
-        /*MinimalImport=*/false
-      );
-      llvm::outs() << "DEBUG: constructed AST importer\n";
-      for (
-        auto top_level_iterator = fromUnit->top_level_begin(), top_level_end = fromUnit->top_level_end();
-        top_level_iterator != top_level_end;
-        top_level_iterator++
-      ) {
-        // ISSUE: we sometimes try to re-import existing definitions;
-        // we just want to skip those!
-        clang::Decl *fromDecl = *top_level_iterator;
-        llvm::Expected<clang::Decl*> importedOrError = importer.Import(fromDecl);
-        if (!importedOrError) {
-          llvm::Error error = importedOrError.takeError();
-          llvm::errs()
-            << "WARNING: error when attemping to merge decl ["
-            << toString(std::move(error))
-            << "]\n";
-          // fromDecl->dump();
-          // llvm::errs() << "\n";
-          // abort();
+      std::set<std::string> importedFiles;
+      {
+        auto const &fromSourceManager = fromUnit->getSourceManager();
+        clang::ASTImporter importer(
+          toUnit->getASTContext(),
+          toUnit->getFileManager(),
+          fromUnit->getASTContext(),
+          fromUnit->getFileManager(),
+          /*MinimalImport=*/false,
+          sharedState
+        );
+        llvm::outs() << "DEBUG: constructed AST importer\n";
+
+        for (clang::Decl *fromDecl : getTopLevelDecls(*fromUnit)) {
+          if (!shouldImport(fromSourceManager, fromDecl, mergedFiles)) {
+            numSkippedDecls++;
+            continue;
+          }
+          importedFiles.insert(getFileName(fromSourceManager, fromDecl));
+          if (isAlreadyDefined(toUnit->getASTContext(), *sharedState->getLookupTable(), fromDecl)) {
+            numExistingDefinitions++;
+            continue;
+          }
+          numImportedDecls++;
+
+          llvm::Expected<clang::Decl*> importedOrError = importer.Import(fromDecl);
+          if (!importedOrError) {
+            llvm::Error error = importedOrError.takeError();
+            llvm::errs()
+              << "WARNING: error when attemping to merge decl ["
+              << toString(std::move(error))
+              << "]\n";
+            // fromDecl->dump();
+            // llvm::errs() << "\n";
+            // abort();
+          }
         }
       }
+      mergedFiles.insert(importedFiles.begin(), importedFiles.end());
+
+      // everything that we need has been copied into the merged AST, so the source AST can go
+      asts[i].reset();
     }
 
+    llvm::outs()
+      << "imported " << numImportedDecls << " top-level decls and skipped "
+      << numSkippedDecls << " decls from headers that were already merged or aren't analyzed\n"
+      << "skipped " << numExistingDefinitions << " definitions that were already part of the merged AST\n";
     llvm::outs() << "successfully merged " << numAsts << " ASTs into a single AST for analysis\n";
     mergedAst = std::move(asts[0]);
   }
 
+  /**
+   * Analyzes each translation unit separately instead of merging their ASTs. This happens in
+   * two passes. The first pass summarizes the call graph of each translation unit, and links those
+   * summaries to find the relevant functions of the whole program. The second pass symbolizes the
+   * relevant functions of each translation unit, and links the results into the program. Each AST
+   * is destroyed as soon as it has been processed, so the ASTs are parsed twice; the AST cache
+   * avoids most of the cost of the second parse.
+   */
+  void runLinked() {
+    auto commands = prepareCompileCommands();
+    llvm::outs()
+      << "summarizing " << commands.size() << " translation units using "
+      << getNumJobs() << " jobs..\n";
+    CallGraphSummary summary;
+    {
+      PhaseMemoryReporter reporter("summarize");
+      forEachAST(commands, [&](clang::ASTUnit &ast) {
+        llvm::outs() << "summarizing translation unit: " << ast.getOriginalSourceFileName() << "\n";
+        summary.link(Symbolizer::summarize(ast.getASTContext(), restrictAnalysisToPaths, options));
+      });
+    }
+    auto relevantFunctions = summary.findRelevantFunctions();
+    llvm::outs() << "found " << relevantFunctions.size() << " relevant functions across all translation units\n";
+
+    PhaseMemoryReporter reporter("symbolize");
+    forEachAST(commands, [&](clang::ASTUnit &ast) {
+      llvm::outs() << "symbolizing translation unit: " << ast.getOriginalSourceFileName() << "\n";
+      SymbolicContext unitContext;
+      Symbolizer::symbolize(
+        ast.getASTContext(),
+        unitContext,
+        restrictAnalysisToPaths,
+        options,
+        &relevantFunctions
+      );
+      program->getContext().link(unitContext);
+    });
+    llvm::outs() << "linked " << commands.size() << " translation units\n";
+  }
+
   void run() {
+    if (options.linkSummaries) {
+      runLinked();
+      return;
+    }
+
     buildAST();
+    PhaseMemoryReporter reporter("symbolize");
     Symbolizer::symbolize(
       mergedAst->getASTContext(),
       program->getContext(),
-      restrictAnalysisToPaths
+      restrictAnalysisToPaths,
+      options
     );
   }
 };
@@ -7,9 +7,10 @@
 #include <clang/AST/ExprCXX.h>
 #include <llvm/ADT/APInt.h>
 
+#include "../Helper/Log.h"
 #include "../Builder/ValueBuilder.h"
 #include "../Value/String.h"
-#include "../Helper/FindDefVisitor.h"
+#include "../Helper/ReachingDefinitions.h"
 
 namespace rosdiscover {
 
@@ -17,21 +18,22 @@ class StringSymbolizer {
 public:
   StringSymbolizer(
     clang::ASTContext &astContext,
-    std::unordered_map<clang::Expr const *, SymbolicVariable *> &apiCallToVar
+    std::unordered_map<clang::Expr const *, SymbolicVariable *> &apiCallToVar,
+    ReachingDefinitions &reachingDefinitions
   )
-  : astContext(astContext), apiCallToVar(apiCallToVar), valueBuilder() {}
+  : astContext(astContext), apiCallToVar(apiCallToVar), reachingDefinitions(reachingDefinitions), valueBuilder() {}
 
   std::unique_ptr<SymbolicString> symbolize(const clang::Expr *expr) {
     if (expr == nullptr) {
-      llvm::outs() << "ERROR! Symbolizing (str): NULLPTR";
+      Log::outs() << "ERROR! Symbolizing (str): NULLPTR";
       return valueBuilder.unknown();
     }
 
     expr = expr->IgnoreParenCasts();
 
-    llvm::outs() << "symbolizing (str): ";
-    expr->dump();
-    llvm::outs() << "\n";
+    Log::outs() << "symbolizing (str): ";
+    expr->dump(Log::outs(), astContext);
+    Log::outs() << "\n";
 
     if (auto *callExpr = clang::dyn_cast<clang::CallExpr>(expr)) {
       // is this expression mapped to a ROS API call?
@@ -41,7 +43,7 @@ public:
 
       if (auto *callee = callExpr->getDirectCallee()) {
         auto calleeName = callee->getQualifiedNameAsString();
-        llvm::outs() << "DEBUG: checking call to function [" << calleeName << "]\n";
+        Log::outs() << "DEBUG: checking call to function [" << calleeName << "]\n";
         if (calleeName == "ros::this_node::getName") {
           return valueBuilder.nodeName();
         } else if (calleeName == "std::operator+") {
@@ -67,13 +69,14 @@ public:
       return symbolize(materializeTempExpr);
     }
 
-    llvm::outs() << "unable to symbolize expression (str): treating as unknown\n";
+    Log::outs() << "unable to symbolize expression (str): treating as unknown\n";
     return valueBuilder.unknown();
   }
 
 private:
   clang::ASTContext &astContext;
   std::unordered_map<clang::Expr const *, SymbolicVariable *> &apiCallToVar;
+  ReachingDefinitions &reachingDefinitions;
   ValueBuilder valueBuilder;
 
   std::unique_ptr<SymbolicString> symbolize(const clang::StringLiteral *literal) {
@@ -89,19 +92,19 @@ private:
     // FIXME this is a bit hacky and may break when other libc++ versions are used
     //
     auto constructorName = expr->getConstructor()->getParent()->getQualifiedNameAsString();
-    llvm::outs() << "calling constructor: " << constructorName << "\n";
+    Log::outs() << "calling constructor: " << constructorName << "\n";
     if (constructorName == "std::__cxx11::basic_string" || constructorName == "std::basic_string") {
       if (expr->getNumArgs() == 0) {
-        llvm::outs() << "DEBUG: unimplemented [resolve indirect string variable definition]: ";
-        expr->dump();
-        llvm::outs() << "\n";
+        Log::outs() << "DEBUG: unimplemented [resolve indirect string variable definition]: ";
+        expr->dump(Log::outs(), astContext);
+        Log::outs() << "\n";
         return valueBuilder.unknown();
       }
 
       return symbolize(expr->getArg(0));
     }
 
-    llvm::outs() << "call to unknown constructor: " << constructorName << "\n";
+    Log::outs() << "call to unknown constructor: " << constructorName << "\n";
     return valueBuilder.unknown();
   }
 
@@ -121,9 +124,9 @@ private:
     // TODO does this refer to a parameter?
 
     if (auto *varDecl = clang::dyn_cast<clang::VarDecl>(nameExpr->getDecl())) {
-      llvm::outs() << "DEBUG: attempting to find definition for var: ";
-      varDecl->dump();
-      llvm::outs() << "\n";
+      Log::outs() << "DEBUG: attempting to find definition for var: ";
+      varDecl->dump(Log::outs());
+      Log::outs() << "\n";
 
       auto *initExpr = varDecl->getInit();
       if (initExpr != nullptr) {
@@ -137,9 +140,9 @@ private:
         return symbolize(def);
       }
 
-      llvm::outs() << "WARNING: unable to find definition for var: ";
-      varDecl->dump();
-      llvm::outs() << "\n";
+      Log::outs() << "WARNING: unable to find definition for var: ";
+      varDecl->dump(Log::outs());
+      Log::outs() << "\n";
     }
 
     return valueBuilder.unknown();
@@ -154,7 +157,7 @@ private:
   }
 
   clang::Expr* findDef(const clang::VarDecl *decl, const clang::Expr *location) {
-    return FindDefVisitor::find(astContext, decl, location);
+    return reachingDefinitions.find(decl, location);
   }
 };
 
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <queue>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -10,38 +10,71 @@
 #include <clang/AST/Decl.h>
 #include <clang/Analysis/CallGraph.h>
 
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
 #include <llvm/Support/raw_ostream.h>
 
+#include "../Helper/Log.h"
 #include "../ApiCall/Finder.h"
 #include "../ApiCall/RosApiCall.h"
 #include "../Ast/Assign/AssignVisitor.h"
 #include "../Ast/Ast.h"
+#include "../Helper/FileClassifier.h"
+#include "../Helper/StmtParentIndex.h"
 #include "../Helper/utils.h"
 #include "../Callback/Callback.h"
+#include "CallerIndex.h"
+#include "CallGraphSummary.h"
+#include "CompactCallGraph.h"
+#include "SymbolizerOptions.h"
 #include "FunctionSymbolizer.h"
 
 namespace rosdiscover {
 
 class Symbolizer {
 public:
+  /**
+   * Symbolizes all relevant functions in a given AST.
+   * If a set of linked relevant functions is given (identified by their USRs), it is used in place
+   * of the relevant functions that would otherwise be computed from the AST. This allows a single
+   * translation unit to be symbolized in isolation, as part of a larger program.
+   */
   static void symbolize(
     clang::ASTContext &astContext,
     SymbolicContext &symContext,
-    std::vector<std::string> &restrictAnalysisToPaths
+    std::vector<std::string> &restrictAnalysisToPaths,
+    SymbolizerOptions const &options = SymbolizerOptions(),
+    std::unordered_set<std::string> const *linkedRelevantFunctions = nullptr
   ) {
-    Symbolizer(astContext, symContext, restrictAnalysisToPaths).run();
+    Symbolizer(astContext, symContext, restrictAnalysisToPaths, options, linkedRelevantFunctions).run();
+  }
+
+  /** Summarizes the call graph and ROS API calls of a single translation unit. */
+  static CallGraphSummary summarize(
+    clang::ASTContext &astContext,
+    std::vector<std::string> &restrictAnalysisToPaths,
+    SymbolizerOptions const &options = SymbolizerOptions()
+  ) {
+    SymbolicContext symContext;
+    return Symbolizer(astContext, symContext, restrictAnalysisToPaths, options).summarize();
   }
 
 private:
   Symbolizer(
     clang::ASTContext &astContext,
     SymbolicContext &symContext,
-    std::vector<std::string> &restrictAnalysisToPaths
+    std::vector<std::string> &restrictAnalysisToPaths,
+    SymbolizerOptions const &options,
+    std::unordered_set<std::string> const *linkedRelevantFunctions = nullptr
   )
     : symContext(symContext),
       astContext(astContext),
-      restrictAnalysisToPaths(restrictAnalysisToPaths),
+      fileClassifier(restrictAnalysisToPaths),
+      options(options),
+      linkedRelevantFunctions(linkedRelevantFunctions),
+      callerIndex(),
       callGraph(),
+      callGraphFunctions(),
       apiCalls(),
       callbacks(),
       functionToCallbacks(),
@@ -49,14 +82,23 @@ private:
       functionToApiCalls(),
       relevantFunctions(),
       relevantFunctionCalls(),
-      relevantFunctionNames(),
-      astFunctionToSymbolic()
+      relevantCanonicalFunctions(),
+      relevantCallees(),
+      astFunctionToSymbolic(),
+      nodeHandleCache(),
+      memberInitializers(),
+      parentIndex(astContext)
   {}
 
   SymbolicContext &symContext;
   clang::ASTContext &astContext;
-  std::vector<std::string> &restrictAnalysisToPaths;
+  FileClassifier fileClassifier;
+  SymbolizerOptions const &options;
+  std::unordered_set<std::string> const *linkedRelevantFunctions;
+  std::unique_ptr<CallerIndex> callerIndex;
+  // only holds the relevant functions, which are added on demand
   clang::CallGraph callGraph;
+  std::unordered_set<clang::FunctionDecl const *> callGraphFunctions;
   std::vector<api_call::RosApiCall *> apiCalls;
   std::vector<Callback*> callbacks;
   std::unordered_map<clang::FunctionDecl const *, std::vector<Callback*>> functionToCallbacks;
@@ -64,14 +106,37 @@ private:
   std::unordered_map<clang::FunctionDecl const *, std::vector<api_call::RosApiCall *>> functionToApiCalls;
   std::unordered_set<clang::FunctionDecl const *> relevantFunctions;
   std::unordered_map<clang::FunctionDecl const *, std::vector<clang::Expr *>> relevantFunctionCalls;
-  [[maybe_unused]] std::unordered_set<std::string> relevantFunctionNames;
+  // relevance of callees is decided by canonical decl, which identifies a function within an AST
+  std::unordered_set<clang::FunctionDecl const *> relevantCanonicalFunctions;
+  std::unordered_set<clang::FunctionDecl const *> relevantCallees;
 
   // TODO instead use AnnotatedFunctionDecl and AnnotatedContext
   std::unordered_map<clang::FunctionDecl const*, SymbolicFunction*> astFunctionToSymbolic;
-
-  /** Constructs the call graph */
+  // the node handles stored in fields, shared by all symbolized functions
+  NodeHandleCache nodeHandleCache;
+  // the initializers of the fields of each record, indexed on demand
+  MemberInitializerIndex memberInitializers;
+  // the function and control-flow parent of each statement, indexed on demand
+  StmtParentIndex parentIndex;
+
+  /**
+   * Indexes the callers of the functions in the analyzed files. The full call graph is never
+   * built; call graph nodes are only created for relevant functions (see addToCallGraph).
+   */
   void buildCallGraph() {
-    callGraph.addToCallGraph(astContext.getTranslationUnitDecl());
+    callerIndex = CallerIndex::build(astContext, fileClassifier);
+    Log::outs()
+      << "indexed " << callerIndex->getEdges().size() << " calls between "
+      << callerIndex->getFunctions().size() << " functions\n";
+  }
+
+  /** Adds the definition of a given function, if there is one, to the call graph. */
+  void addToCallGraph(clang::FunctionDecl const *function) {
+    auto const *definition = function->getDefinition();
+    if (definition == nullptr || !callGraphFunctions.insert(definition->getCanonicalDecl()).second) {
+      return;
+    }
+    callGraph.addToCallGraph(const_cast<clang::FunctionDecl *>(definition));
   }
 
   /** Finds all callbacks from ROS API calls that can be statically resolved */
@@ -79,9 +144,10 @@ private:
     for (auto *call : apiCalls) {
       auto *callback = call->getCallback(astContext);
       if (callback != nullptr) {
-        llvm::outs() << "DEBUG: registering callback: ";
-        callback->print(llvm::outs());
-        llvm::outs() << "\n";
+        callback->setParentFunction(parentIndex.getFunction(call->getExpr()));
+        Log::outs() << "DEBUG: registering callback: ";
+        callback->print(Log::outs());
+        Log::outs() << "\n";
         callbacks.push_back(callback);
       }
     }
@@ -89,59 +155,36 @@ private:
 
   /** Finds all direct ROS API calls */
   void findRosApiCalls() {
-    llvm::outs() << "DEBUG: finding ROS API calls...\n";
-    apiCalls = api_call::RosApiCallFinder::find(astContext);
-    llvm::outs() << "DEBUG: found ROS API calls\n";
+    Log::outs() << "DEBUG: finding ROS API calls...\n";
+    // API calls outside of the paths that we're allowed to analyze are never visited
+    apiCalls = api_call::RosApiCallFinder::find(astContext, fileClassifier, options.numMatchJobs);
+    Log::outs() << "DEBUG: found ROS API calls\n";
 
     // group API calls by parent function
-    llvm::outs() << "DEBUG: grouping ROS API calls by parent function...\n";
+    Log::outs() << "DEBUG: grouping ROS API calls by parent function...\n";
     for (auto *call : apiCalls) {
       auto *expr = call->getExpr();
-      llvm::outs() << "DEBUG: examining API call...\n";
-      auto *functionDecl = getParentFunctionDecl(astContext, expr);
-      // llvm::outs() << "DEBUG: parent function for API call: ";
+      Log::outs() << "DEBUG: examining API call...\n";
+      auto *functionDecl = parentIndex.getFunction(expr);
+      // Log::outs() << "DEBUG: parent function for API call: ";
       // functionDecl->dump();
-      // llvm::outs() << "\n";
+      // Log::outs() << "\n";
       // functionDecl = functionDecl->getCanonicalDecl();
-      llvm::outs() << "DEBUG: found canonical definition for parent function\n";
+      Log::outs() << "DEBUG: found canonical definition for parent function\n";
       if (functionDecl == nullptr) {
-        llvm::errs() << "failed to determine parent function for ROS API call\n";
+        Log::errs() << "failed to determine parent function for ROS API call\n";
         continue;
       }
 
-      // check to see whether this API call takes place in a file
-      // that we're allowed to analyze
-      if (!restrictAnalysisToPaths.empty()) {
-        llvm::outs() << "DEBUG: finding name of file that API calls appears in...\n";
-        auto filename = clang::FullSourceLoc(
-          expr->getBeginLoc(),
-          astContext.getSourceManager()
-        ).getFileEntry()->getName().str();
-        llvm::outs() << "DEBUG: API call belongs to file: " << filename << "\n";
-
-        bool ignoreFile = true;
-        for (auto const &allowedPath : restrictAnalysisToPaths) {
-          if (starts_with(filename, allowedPath)) {
-            ignoreFile = false;
-            break;
-          }
-        }
-
-        if (ignoreFile) {
-          llvm::outs() << "ignoring API call in: " << filename << "\n";
-          continue;
-        }
-      }
-
       if (functionToApiCalls.find(functionDecl) == functionToApiCalls.end()) {
         functionToApiCalls.emplace(functionDecl, std::vector<api_call::RosApiCall *>());
       }
       functionToApiCalls[functionDecl].push_back(call);
     }
-    llvm::outs() << "grouped ROS API calls by parent function\n";
+    Log::outs() << "grouped ROS API calls by parent function\n";
 
     for (auto const &entry : functionToApiCalls) {
-      llvm::outs()
+      Log::outs()
         << "ROS API calls found in function: "
         << entry.first->getQualifiedNameAsString()
         << " ["
@@ -152,58 +195,122 @@ private:
 
   /** Computes the set of architecturally-relevant functions */
   void findRelevantFunctions() {
-    llvm::outs() << "computing relevant functions...\n";
-    llvm::outs() << "determining function callers\n";
-    auto functionToCallers = findCallers(callGraph);
-    llvm::outs() << "determined function callers\n";
+    Log::outs() << "computing relevant functions...\n";
 
-    // handle callbacks
+    // the target of a callback is relevant if the function that registers it is
+    // FIXME the target function MAY be different
+    std::vector<CompactCallGraph::Edge> callbackEdges;
     for (auto *callback : callbacks) {
-      auto *parentFunction = callback->getParentFunction();
-      auto *targetFunction = callback->getTargetFunction();
-      // FIXME the target function MAY be different
-      functionToCallers[parentFunction].insert(targetFunction);
+      callbackEdges.emplace_back(callback->getParentFunction(), callback->getTargetFunction());
     }
+    CompactCallGraph graph(callerIndex->getEdges(), callbackEdges);
+    Log::outs() << "built compact call graph with " << graph.size() << " functions\n";
 
-    std::queue<clang::FunctionDecl const *> queue;
+    // functions with API calls are kept as they are, since API calls are grouped by them
+    std::vector<clang::FunctionDecl const *> apiCallFunctions;
     for (auto const &entry : functionToApiCalls) {
-      queue.push(entry.first);
+      apiCallFunctions.push_back(entry.first);
+      relevantFunctions.insert(entry.first);
     }
+    auto reached = graph.findTransitiveCallers(apiCallFunctions);
+    for (auto const *function : apiCallFunctions) {
+      auto index = graph.getIndex(function);
+      if (index >= 0) {
+        reached.reset(index);
+      }
+    }
+    for (auto index : reached.set_bits()) {
+      relevantFunctions.insert(graph.getFunction(index));
+    }
+
+    for (auto const *function : relevantFunctions) {
+      relevantCanonicalFunctions.insert(function->getCanonicalDecl());
+      Log::outs() << "found relevant function: " << function->getQualifiedNameAsString() << "\n";
+    }
+
+    Log::outs() << "finished finding all relevant functions\n";
+  }
 
-    while (!queue.empty()) {
-      auto const *function = queue.front();
-      relevantFunctions.insert(function);
-      queue.pop();
+  /**
+   * Computes the set of relevant functions that are defined in this AST from a set of relevant
+   * functions that was computed by linking the call graph summaries of all translation units.
+   */
+  void findLinkedRelevantFunctions() {
+    std::unordered_map<std::string, clang::FunctionDecl const *> idToFunction;
 
-      for (auto caller : functionToCallers[function]) {
-        if (relevantFunctions.find(caller) == relevantFunctions.end())
-          queue.push(caller);
+    // we prefer the decls that API calls are grouped by, since those are used as keys later
+    for (auto const &entry : functionToApiCalls) {
+      idToFunction.emplace(getFunctionId(entry.first), entry.first);
+    }
+    for (auto const *function : callerIndex->getFunctions()) {
+      auto id = getFunctionId(function);
+      if (linkedRelevantFunctions->find(id) == linkedRelevantFunctions->end()) {
+        continue;
+      }
+      relevantCanonicalFunctions.insert(function->getCanonicalDecl());
+      if (function->hasBody()) {
+        idToFunction.emplace(id, function);
       }
     }
 
-    for (auto const *function : relevantFunctions) {
-      auto name = function->getQualifiedNameAsString();
-      relevantFunctionNames.insert(name);
-      llvm::outs() << "found relevant function: " << name << "\n";
+    for (auto const &entry : idToFunction) {
+      if (linkedRelevantFunctions->find(entry.first) != linkedRelevantFunctions->end()) {
+        relevantFunctions.insert(entry.second);
+        relevantCanonicalFunctions.insert(entry.second->getCanonicalDecl());
+        Log::outs() << "found relevant function: " << entry.second->getQualifiedNameAsString() << "\n";
+      }
     }
+    Log::outs() << "finished finding all relevant functions\n";
+  }
+
+  /** Produces a summary of the call graph that can be linked with those of other translation units. */
+  CallGraphSummary summarize() {
+    buildCallGraph();
+    findRosApiCalls();
+    findCallbacks();
+
+    CallGraphSummary summary;
+    auto addFunction = [&summary](clang::FunctionDecl const *function) {
+      auto id = getFunctionId(function);
+      summary.addName(id, function->getQualifiedNameAsString());
+      return id;
+    };
 
-    llvm::outs() << "finished finding all relevant functions\n";
+    for (auto const &entry : functionToApiCalls) {
+      summary.addApiCallFunction(addFunction(entry.first));
+    }
+    for (auto const &edge : callerIndex->getEdges()) {
+      summary.addCaller(addFunction(edge.first), addFunction(edge.second));
+    }
+    // FIXME the target function MAY be different (see findRelevantFunctions)
+    for (auto *callback : callbacks) {
+      summary.addCaller(
+        addFunction(callback->getParentFunction()),
+        addFunction(callback->getTargetFunction())
+      );
+    }
+    return summary;
   }
 
   void findRelevantCallbacks() {
     for (auto *callback : callbacks) {
       auto *parentFunction = callback->getParentFunction();
       auto *targetFunction = callback->getTargetFunction();
-      if (relevantFunctions.find(targetFunction) != relevantFunctions.end()) {
-        llvm::outs() << "DEBUG: callback is relevant: ";
-        callback->print(llvm::outs());
-        llvm::outs() << "\n";
+      bool isRelevant = relevantCanonicalFunctions.find(targetFunction->getCanonicalDecl()) != relevantCanonicalFunctions.end()
+        || (
+             linkedRelevantFunctions != nullptr
+          && linkedRelevantFunctions->find(getFunctionId(targetFunction)) != linkedRelevantFunctions->end()
+        );
+      if (isRelevant) {
+        Log::outs() << "DEBUG: callback is relevant: ";
+        callback->print(Log::outs());
+        Log::outs() << "\n";
         if (relevantCallbacks.find(parentFunction) == relevantCallbacks.end()) {
           relevantCallbacks[parentFunction] = {};
         }
         relevantCallbacks[parentFunction].push_back(callback);
       } else {
-        llvm::outs()
+        Log::outs()
           << "DEBUG: callback deemed irrelevant: "
           << targetFunction->getQualifiedNameAsString()
           << "\n";
@@ -214,58 +321,44 @@ private:
   void findRelevantFunctionCalls() {
     // look at all function calls within the set of relevant functions
     for (auto const *caller : relevantFunctions) {
-      llvm::outs()
+      Log::outs()
         << "finding all calls to relevant function: "
         << caller->getQualifiedNameAsString()
         << "\n";
       relevantFunctionCalls.emplace(caller, std::vector<clang::Expr *>());
+      addToCallGraph(caller);
       auto *callerNode = callGraph.getNode(caller);
 
       if (callerNode == nullptr) {
-        llvm::errs()
+        Log::errs()
           << "Call graph node is missing for relevant function ["
           << caller->getQualifiedNameAsString()
           << "]. Trying to use canonical declaration as a workaround. \n";
 
         callerNode = callGraph.getNode(caller->getCanonicalDecl());
         if (callerNode == nullptr) {
-          llvm::errs() << "Canonical decl workaround didn't work\n";
+          Log::errs() << "Canonical decl workaround didn't work\n";
           continue;
         } else {
-          llvm::outs() << "DEBUG: canonical workaround worked!\n";
+          Log::outs() << "DEBUG: canonical workaround worked!\n";
         }
       }
-      llvm::outs() << "-> fetched call graph node\n";
+      Log::outs() << "-> fetched call graph node\n";
 
       for (clang::CallGraphNode::CallRecord const &callRecord : *callerNode) {
         // is this a call to another relevant function?
-        auto const *callee = clang::dyn_cast<clang::FunctionDecl>(callRecord.Callee->getDecl());
-        // auto const *canonicalCallee = callee->getCanonicalDecl();
-        auto calleeName = callee->getQualifiedNameAsString();
-        llvm::outs()
-          << "DEBUG: CHECKING IF CALL IS RELEVANT [dest: "
-          << calleeName
-          << "\n";
-
-        if (relevantFunctionNames.find(calleeName) != relevantFunctionNames.end()) {
-          llvm::outs() << "DEBUG: MATCH\n";
+        auto const *callee = clang::dyn_cast_or_null<clang::FunctionDecl>(callRecord.Callee->getDecl());
+        if (callee == nullptr) {
+          continue;
+        }
+        callee = callee->getCanonicalDecl();
+        if (relevantCanonicalFunctions.find(callee) != relevantCanonicalFunctions.end()) {
           relevantFunctionCalls[caller].push_back(callRecord.CallExpr);
-        } else {
-          llvm::outs() << "DEBUG: NO MATCH\n";
+          relevantCallees.insert(callee);
         }
-
-        // if (relevantFunctions.find(callee) != relevantFunctions.end()) {
-        //   llvm::outs() << "DEBUG: FOUND NON-CANONICAL MATCH\n";
-        //   relevantFunctionCalls[caller].push_back(callRecord.CallExpr);
-        // } else if (relevantFunctions.find(canonicalCallee) != relevantFunctions.end()) {
-        //   llvm::outs() << "DEBUG: FOUND CANONICAL MATCH\n";
-        //   relevantFunctionCalls[caller].push_back(callRecord.CallExpr);
-        // } else {
-        //   llvm::outs() << "DEBUG: NO MATCH\n";
-        // }
       }
 
-      llvm::outs()
+      Log::outs()
         << caller->getQualifiedNameAsString()
         << ": found "
         << relevantFunctionCalls[caller].size()
@@ -274,24 +367,25 @@ private:
       // attempting to dump certain function calls sometimes leads to a crash?
       // for (auto call : relevantFunctionCalls[caller]) {
       //   call->dumpColor();
-      //   llvm::outs() << "\n";
+      //   Log::outs() << "\n";
       // }
     }
 
-    llvm::outs() << "finished finding all relevant functions calls\n";
+    Log::outs() << "finished finding all relevant functions calls\n";
   }
 
   void symbolize(clang::FunctionDecl const *function) {
-    llvm::outs()
+    Log::outs()
       << "symbolizing function: "
       << function->getQualifiedNameAsString()
       << "\n";
-    auto *symFunction = astFunctionToSymbolic[function];
-    auto &apiCalls = functionToApiCalls[function];
-    auto &functionCalls = relevantFunctionCalls[function];
-    auto &callbacks = relevantCallbacks[function];
+    // the maps are only read here, since functions may be symbolized concurrently
+    auto *symFunction = astFunctionToSymbolic.at(function);
+    auto &apiCalls = functionToApiCalls.at(function);
+    auto &functionCalls = relevantFunctionCalls.at(function);
+    auto &callbacks = relevantCallbacks.at(function);
 
-    llvm::outs()
+    Log::outs()
       << "using " << callbacks.size() << " relevant callbacks during symbolization\n";
 
     FunctionSymbolizer::symbolize(
@@ -301,39 +395,110 @@ private:
         function,
         apiCalls,
         functionCalls,
-        callbacks
+        callbacks,
+        nodeHandleCache,
+        memberInitializers,
+        parentIndex
     );
-    llvm::outs()
+    Log::outs()
       << "symbolized function: "
       << function->getQualifiedNameAsString()
       << "\n";
   }
 
+  /**
+   * Symbolizes the relevant functions on a pool of threads. Symbolizing a function only depends
+   * on the declarations of the functions that it calls, which all exist at this point, so
+   * functions can be symbolized in any order. The only exception are decls of the same function
+   * (e.g., its canonical decl and its definition), which share a symbolic function and are
+   * therefore symbolized one after another by the same task. Each task buffers its log output.
+   */
+  void symbolizeConcurrently() {
+    // the parent map of the AST is built lazily on first use
+    astContext.getParents(*astContext.getTranslationUnitDecl());
+
+    std::unordered_map<SymbolicFunction *, std::vector<clang::FunctionDecl const *>> symbolicToFunctions;
+    std::vector<SymbolicFunction *> tasks;
+    for (auto const *function : relevantFunctions) {
+      auto *symFunction = astFunctionToSymbolic.at(function);
+      auto &functions = symbolicToFunctions[symFunction];
+      if (functions.empty()) {
+        tasks.push_back(symFunction);
+      }
+      functions.push_back(function);
+    }
+
+    llvm::ThreadPool pool(llvm::hardware_concurrency(options.numSymbolizeJobs));
+    for (auto *symFunction : tasks) {
+      auto const &functions = symbolicToFunctions.at(symFunction);
+      pool.async([this, &functions] {
+        Log::Buffer buffer;
+        for (auto const *function : functions) {
+          symbolize(function);
+        }
+      });
+    }
+    pool.wait();
+  }
+
   void run() {
     buildCallGraph();
     findRosApiCalls();
     findCallbacks();
-    findRelevantFunctions();
+    if (linkedRelevantFunctions == nullptr) {
+      findRelevantFunctions();
+    } else {
+      findLinkedRelevantFunctions();
+    }
     findRelevantFunctionCalls();
     findRelevantCallbacks();
 
     // declare all of the relevant functions
-    llvm::outs() << "declaring symbolic functions\n";
+    Log::outs() << "declaring symbolic functions\n";
+    std::unordered_set<clang::FunctionDecl const *> declared;
     for (auto const *function : relevantFunctions) {
       astFunctionToSymbolic.emplace(function, symContext.declare(astContext, function));
+      declared.insert(function->getCanonicalDecl());
     }
-    llvm::outs() << "declared symbolic functions\n";
+
+    // when a translation unit is symbolized in isolation, relevant functions that are called
+    // here may be defined elsewhere, but they still need to be declared
+    for (auto const *callee : relevantCallees) {
+      if (declared.insert(callee).second) {
+        symContext.declare(astContext, callee);
+      }
+    }
+    for (auto const &entry : relevantCallbacks) {
+      for (auto *callback : entry.second) {
+        auto const *target = callback->getTargetFunction();
+        if (declared.insert(target->getCanonicalDecl()).second) {
+          symContext.declare(astContext, target);
+        }
+      }
+    }
+    Log::outs() << "declared symbolic functions\n";
 
     // produce initial definitions for each function
-    llvm::outs() << "obtaining symbolic function definitions...\n";
-    
+    Log::outs() << "obtaining symbolic function definitions...\n";
     for (auto const *function : relevantFunctions) {
-      symbolize(function);      
+      functionToApiCalls[function];
+      relevantFunctionCalls[function];
+      relevantCallbacks[function];
+    }
+    // ASTs with an external source (e.g., loaded from the AST cache or built on a shared preamble)
+    // deserialize decls on demand, which isn't thread safe, so they are symbolized on one thread
+    auto numThreads = llvm::hardware_concurrency(options.numSymbolizeJobs).compute_thread_count();
+    if (numThreads <= 1 || relevantFunctions.size() <= 1 || astContext.getExternalSource() != nullptr) {
+      for (auto const *function : relevantFunctions) {
+        symbolize(function);
+      }
+    } else {
+      symbolizeConcurrently();
     }
-    llvm::outs() << "obtained symbolic function definitions...\n";
+    Log::outs() << "obtained symbolic function definitions...\n";
 
-    symContext.print(llvm::outs());
-    llvm::outs() << "\n";
+    symContext.print(Log::outs());
+    Log::outs() << "\n";
   }
 };
 
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+
+#include "../Frontend/CompileCommands.h"
+
+namespace rosdiscover {
+
+/** Settings that control how the ASTs for a program are built and analyzed. */
+struct SymbolizerOptions {
+  /** The number of translation units that should be parsed concurrently (0 uses all cores). */
+  unsigned numJobs = 1;
+
+  /** Determines which compile command is parsed for a source file that is built by several targets. */
+  DuplicateCommandPolicy duplicateCommandPolicy = DuplicateCommandPolicy::KeepFirst;
+
+  /** Whether translation units that don't mention the ROS API should be skipped before parsing. */
+  bool useRosApiPrefilter = false;
+
+  /** The directory in which serialized ASTs are cached between runs (empty disables the cache). */
+  std::string astCacheDirectory;
+
+  /** Whether translation units with the same flags should share a precompiled header for their common includes. */
+  bool useSharedPreambles = false;
+
+  /** Whether each translation unit should be analyzed separately and linked, rather than merging their ASTs. */
+  bool linkSummaries = false;
+
+  /** A soft limit on resident memory, in MiB, that bounds how many ASTs are held at once; only valid with linkSummaries (0 disables the limit). */
+  unsigned memoryLimitMiB = 0;
+
+  /** The number of threads that search an AST for ROS API calls, each in its own shard of top-level decls (0 uses all cores). */
+  unsigned numMatchJobs = 1;
+
+  /** The number of threads that symbolize the relevant functions of an AST (0 uses all cores). */
+  unsigned numSymbolizeJobs = 1;
+};
+
+} // rosdiscover
@@ -4,6 +4,7 @@
 
 #include <clang/AST/Stmt.h>
 
+#include "../Helper/Log.h"
 #include "../ApiCall/RosApiCall.h"
 #include "../Helper/utils.h"
 #include "../ApiCall/Calls/Util.h"
@@ -27,7 +28,7 @@ public:
           return unaryOperator;
         }
       }
-      llvm::outs() << "[Callback] ERROR: Couldn't find UnaryOperator or DeclRefExpr call argument in MaterializeTemporaryExpr.";
+      Log::outs() << "[Callback] ERROR: Couldn't find UnaryOperator or DeclRefExpr call argument in MaterializeTemporaryExpr.";
       return nullptr;
   }
   
@@ -36,9 +37,9 @@ public:
     api_call::RosApiCall const *apiCall,
     clang::Expr const *argExpr
   ) {
-    llvm::outs() << "DEBUG: attempting to extract callback from expr: ";
-    argExpr->dump();
-    llvm::outs() << "\n";
+    Log::outs() << "DEBUG: attempting to extract callback from expr: ";
+    argExpr->dump(Log::outs(), context);
+    Log::outs() << "\n";
     if (argExpr == nullptr) {
       return unableToResolve(argExpr);
     }
@@ -61,9 +62,9 @@ public:
           if (tempExpr == nullptr) {
             return unableToResolve(argExpr);
           }
-          llvm::outs() << "[Callback] is MaterializeTemporaryExpr: ";
-          tempExpr->dump();
-          llvm::outs() << "\n";
+          Log::outs() << "[Callback] is MaterializeTemporaryExpr: ";
+          tempExpr->dump(Log::outs(), context);
+          Log::outs() << "\n";
 
           
           return fromArgExpr(context, apiCall, unwrapMaterializeTemporaryExpr(tempExpr));
@@ -102,20 +103,27 @@ public:
     api_call::RosApiCall const *apiCall,
     clang::FunctionDecl const *target
   ) {
-    auto *callExpr = apiCall->getExpr();
-    auto *parent = getParentFunctionDecl(context, callExpr);
     target = target->getCanonicalDecl();
-    return new Callback(apiCall, parent, target);
+    return new Callback(context, apiCall, target);
   }
 
   api_call::RosApiCall const * getApiCall() const {
     return apiCall;
   }
 
+  /** Returns the function that registers this callback, which is only determined when it is first needed. */
   clang::FunctionDecl const * getParentFunction() const {
+    if (parent == nullptr) {
+      parent = getParentFunctionDecl(context, apiCall->getExpr());
+    }
     return parent;
   }
 
+  /** Sets the function that registers this callback, if it is already known to the caller. */
+  void setParentFunction(clang::FunctionDecl const *function) {
+    parent = function;
+  }
+
   clang::FunctionDecl const * getTargetFunction() const {
     return target;
   }
@@ -125,9 +133,9 @@ public:
     apiCall->print(os);
     os 
       << "], "
-      << parent->getQualifiedNameAsString()
+      << getParentFunction()->getQualifiedNameAsString()
       << " {"
-      << &(*parent)
+      << &(*getParentFunction())
       << "} -> "
       << target->getQualifiedNameAsString()
       << &(*target)
@@ -137,20 +145,21 @@ public:
 
 private:
   Callback(
+    clang::ASTContext &context,
     api_call::RosApiCall const *apiCall,
-    clang::FunctionDecl const *parent,
     clang::FunctionDecl const *target
-  ) : apiCall(apiCall), parent(parent), target(target) {}
+  ) : context(context), apiCall(apiCall), parent(nullptr), target(target) {}
 
   static Callback* unableToResolve(clang::Expr const *argExpr) {
-    llvm::outs() << "WARNING: unable to resolve callback from expression: ";
-    argExpr->dump();
-    llvm::outs() << "\n";
+    Log::outs() << "WARNING: unable to resolve callback from expression: ";
+    argExpr->printPretty(Log::outs(), nullptr, clang::PrintingPolicy(clang::LangOptions()));
+    Log::outs() << "\n";
     return nullptr;
   }
 
+  clang::ASTContext &context;
   api_call::RosApiCall const *apiCall;
-  clang::FunctionDecl const *parent;
+  mutable clang::FunctionDecl const *parent;
   clang::FunctionDecl const *target;
 };
 
@@ -1,10 +1,12 @@
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include <clang/AST/ASTContext.h>
 #include <clang/AST/Stmt.h>
 
+#include "../Helper/Log.h"
 #include "CFGEdge.h"
 #include "../BackwardSymbolizer/ExprSymbolizer.h"
 
@@ -15,7 +17,14 @@ class CFGBlock {
 public:
   CFGBlock(
     const clang::CFGBlock* clangBlock
-  ) : clangBlock(clangBlock), predecessors(), successors() {}
+  ) : clangBlock(clangBlock),
+      predecessors(),
+      successors(),
+      isConditionSymbolized(false),
+      condition(),
+      isPathConditionComputed(false),
+      pathCondition()
+  {}
   ~CFGBlock(){}
 
   const clang::CFGBlock* getClangBlock() const {
@@ -30,31 +39,46 @@ public:
     return predecessors;
   }
 
-  std::string getConditionStr(const clang::ASTContext &astContext, ExprSymbolizer &exprSymbolizer) const {
-    const auto *condition = clangBlock->getTerminatorCondition();
-    if (condition == nullptr) {
+  std::string getConditionStr(const clang::ASTContext &astContext, ExprSymbolizer &exprSymbolizer) {
+    auto symbolicCondition = getCondition(astContext, exprSymbolizer);
+    if (symbolicCondition == nullptr) {
       return "true"; //No condition in block
     }
-    auto *conditionExpr = clang::dyn_cast<clang::Expr>(condition);
+    return symbolicCondition->toString();
+  }
+
+  /** Returns the symbolized terminator condition of this block, or nullptr if it has none. */
+  std::shared_ptr<SymbolicExpr const> getCondition(const clang::ASTContext &astContext, ExprSymbolizer &exprSymbolizer) {
+    if (isConditionSymbolized) {
+      return condition;
+    }
+    isConditionSymbolized = true;
+
+    const auto *terminatorCondition = clangBlock->getTerminatorCondition();
+    if (terminatorCondition == nullptr) {
+      return nullptr;
+    }
+    auto *conditionExpr = clang::dyn_cast<clang::Expr>(terminatorCondition);
     if (conditionExpr == nullptr) {
-      llvm::outs() << "ERROR: Terminiator condition is no expression: ";
-      condition->dump();
+      Log::outs() << "ERROR: Terminiator condition is no expression: ";
+      terminatorCondition->dump(Log::outs(), astContext);
       abort();
     }
-    auto symbolicCondition = exprSymbolizer.symbolize(conditionExpr);
-
-    auto result = symbolicCondition->toString();
-    llvm::outs() << "[DEBUG] Symbolized Expr: " << result << " for: " << prettyPrint(condition, astContext) << "\n";
-    
-    return result;
+    condition = exprSymbolizer.symbolize(conditionExpr);
+    Log::outs() << "[DEBUG] Symbolized Expr: " << condition->toString() << " for: " << prettyPrint(conditionExpr, astContext) << "\n";
+    return condition;
   }
 
-  std::unique_ptr<SymbolicExpr> getFullConditionExpr(
-      bool includeSelf,
-      const clang::ASTContext &astContext,
-      bool negate,
-      ExprSymbolizer &exprSymbolizer
-    ) const {
+  /**
+   * Returns the disjunction of the conditions under which this block is reached from its
+   * predecessors in the control dependence graph, or nullptr if it is reached unconditionally.
+   * The result is computed once and is then shared by all successors of this block.
+   */
+  std::shared_ptr<SymbolicExpr const> getPathCondition(const clang::ASTContext &astContext, ExprSymbolizer &exprSymbolizer) {
+    if (isPathConditionComputed) {
+      return pathCondition;
+    }
+
     std::unique_ptr<SymbolicExpr> result = nullptr;
     for (auto edge: predecessors) {
       auto pExpr = edge->getPredecessor()->getFullConditionExpr(true, astContext, edge->getType() == CFGEdge::EdgeType::False, exprSymbolizer);
@@ -74,28 +98,42 @@ public:
       }
     }
 
-    if (!includeSelf || clangBlock->getTerminatorCondition() == nullptr) {
+    isPathConditionComputed = true;
+    pathCondition = std::move(result);
+    return pathCondition;
+  }
+
+  std::unique_ptr<SymbolicExpr> getFullConditionExpr(
+      bool includeSelf,
+      const clang::ASTContext &astContext,
+      bool negate,
+      ExprSymbolizer &exprSymbolizer
+    ) {
+    // the conditions of this block and of its predecessors are referenced rather than copied
+    auto sharedPathCondition = getPathCondition(astContext, exprSymbolizer);
+    std::unique_ptr<SymbolicExpr> result = nullptr;
+    if (sharedPathCondition != nullptr) {
+      result = std::make_unique<SharedExpr>(sharedPathCondition);
+    }
+
+    if (!includeSelf) {
       return result;
     }
-    auto condExpr = clang::dyn_cast<clang::Expr>(clangBlock->getTerminatorCondition());
-    if (condExpr == nullptr) {
-      llvm::outs() << "ERROR: Terminiator condition is no expression: ";
-      clangBlock->getTerminatorCondition()->dump();
-      abort();
+    auto sharedCondition = getCondition(astContext, exprSymbolizer);
+    if (sharedCondition == nullptr) {
+      return result;
     }
 
-    auto symbolicCondition = exprSymbolizer.symbolize(condExpr);
-    auto symbolicConditionStr = symbolicCondition->toString();
-    llvm::outs() << "[DEBUG] Symbolized Expr: " << symbolicConditionStr << " for: " << prettyPrint(condExpr, astContext) << "\n";
-    
-    std::unique_ptr<SymbolicExpr> myExpr = negate ? std::make_unique<NegateExpr>(std::move(symbolicCondition)) : std::move(symbolicCondition);
+    std::unique_ptr<SymbolicExpr> myExpr = std::make_unique<SharedExpr>(sharedCondition);
+    if (negate)
+      myExpr = std::make_unique<NegateExpr>(std::move(myExpr));
     if (result == nullptr) 
       return myExpr;
     else
       return std::make_unique<AndExpr>(std::move(result), std::move(myExpr));
   }
 
-  std::unique_ptr<SymbolicExpr> getFullConditionExpr(clang::ASTContext &astContext, ExprSymbolizer &exprSymbolizer) const {
+  std::unique_ptr<SymbolicExpr> getFullConditionExpr(clang::ASTContext &astContext, ExprSymbolizer &exprSymbolizer) {
     auto result = getFullConditionExpr(false, astContext, false, exprSymbolizer);
     if(result == nullptr) {
       return std::make_unique<BoolLiteral>(true);
@@ -107,7 +145,7 @@ public:
     auto edge = new CFGEdge(this, successor, type);
     for (auto pEdge : successors) {
       if (*pEdge == *edge) {
-        llvm::outs() << "Skip redundant edge\n";
+        Log::outs() << "Skip redundant edge\n";
         return false;
       }
     }
@@ -120,6 +158,10 @@ private:
   const clang::CFGBlock* clangBlock;
   std::vector<CFGEdge*> predecessors;
   std::vector<CFGEdge*> successors;
+  bool isConditionSymbolized;
+  std::shared_ptr<SymbolicExpr const> condition;
+  bool isPathConditionComputed;
+  std::shared_ptr<SymbolicExpr const> pathCondition;
 
   void addSuccessor(CFGEdge* edge) {
     successors.push_back(edge);
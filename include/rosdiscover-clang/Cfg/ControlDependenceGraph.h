@@ -1,161 +1,138 @@
 #pragma once
 
+#include <memory>
+#include <unordered_map>
+
+#include <clang/Analysis/Analyses/Dominators.h>
+#include <clang/Analysis/Analyses/PostOrderCFGView.h>
+#include <clang/Analysis/CFG.h>
+#include <llvm/ADT/Optional.h>
+#include <llvm/ADT/SmallVector.h>
+
+#include "../Helper/Log.h"
 #include "CFGBlock.h"
 
 namespace rosdiscover {
+
+/**
+ * The control dependence graph of a single function. Each node has an incoming edge from every
+ * block that it is directly control dependent on, labelled with the branch of that block which
+ * leads to it. Nodes are created on demand, along with their incoming edges, and are then shared
+ * by all statements of the function, so that each block's condition and path condition are
+ * computed once per function.
+ *
+ * Edges only ever lead from a block to one that follows it in reverse postorder, which keeps the
+ * graph acyclic. Whether an edge exists thus depends only on the two blocks that it connects, and
+ * not on the order in which nodes are requested.
+ */
 class ControlDependenceGraph {
 public:
-  ControlDependenceGraph() : idToBlockDict() {}
-  ~ControlDependenceGraph(){}
-  
-  static std::unique_ptr<ControlDependenceGraph> buildGraph(
-      const clang::CFGBlock* clangBlockOfInterest,
-      const llvm::SmallVector<clang::CFGBlock *, 4> &deps,
+  ControlDependenceGraph(
+      clang::ControlDependencyCalculator &controlDependencies,
       clang::CFGDominatorTreeImpl<true> &postdominatorAnalysis,
       clang::CFGDominatorTreeImpl<false> &dominatorAnalysis,
-      clang::ASTContext &astContext,
-      ExprSymbolizer &exprSymbolizer
-    ) {
-    std::vector<const clang::CFGBlock*> analyzed;
-    std::unique_ptr<ControlDependenceGraph> graph = std::make_unique<ControlDependenceGraph>(); //maps BlockID to CFGBlockObject
-    auto cfgBlockOfInterest = graph->getBlock(clangBlockOfInterest);
-    assert(cfgBlockOfInterest != nullptr);
-    std::vector<CFGBlock*> controlDependencyGraphNodes = {cfgBlockOfInterest};
-    for (auto depsBlock: deps) {
-      assert(depsBlock != nullptr);
-      if (postdominatorAnalysis.dominates(depsBlock, clangBlockOfInterest) && !dominatorAnalysis.dominates(depsBlock, clangBlockOfInterest))
-        continue; //ignore CFG blocks that come after the block of interest.
-      auto depsCfgBlock = graph->getBlock(depsBlock);
-      assert(depsCfgBlock != nullptr);
-      controlDependencyGraphNodes.push_back(depsCfgBlock);
-    }
-    llvm::outs() << "#### buildGraph ####\n";
-    graph->buildGraph(true, clangBlockOfInterest, deps, postdominatorAnalysis, dominatorAnalysis, analyzed, controlDependencyGraphNodes, astContext, exprSymbolizer);
-    llvm::outs() << "#### graph built ####\n";
-    return graph;
-  }
-  
+      clang::PostOrderCFGView const &postOrder
+  ) : controlDependencies(controlDependencies),
+      postdominatorAnalysis(postdominatorAnalysis),
+      dominatorAnalysis(dominatorAnalysis),
+      comesBefore(postOrder.getComparator()),
+      idToBlockDict()
+  {}
+  ~ControlDependenceGraph(){}
+
+  /** Returns the node of a given block, after connecting it to the blocks that it depends on. */
   CFGBlock* getBlock(const clang::CFGBlock* block) {
     auto id = block->getBlockID();
-    if (!idToBlockDict.count(id)) { //lazy creation of CFG blocks 
-        idToBlockDict.emplace(id, std::make_unique<CFGBlock>(block));
+    auto it = idToBlockDict.find(id);
+    if (it != idToBlockDict.end()) {
+      return it->second.get();
     }
-    return idToBlockDict.at(id).get();
-  }
+    auto *node = idToBlockDict.emplace(id, std::make_unique<CFGBlock>(block)).first->second.get();
 
-private: 
-  std::unordered_map<long, std::unique_ptr<CFGBlock>> idToBlockDict;
-
-  // Recursively builds a graph of control dependencies starting from the last block.
-  std::vector<CFGBlock*> buildGraph(
-    bool first,
-    const clang::CFGBlock* block,
-    const llvm::SmallVector<clang::CFGBlock *, 4> &deps,
-    clang::CFGDominatorTreeImpl<true> &postdominatorAnalysis,
-    clang::CFGDominatorTreeImpl<false> &dominatorAnalysis,
-    std::vector<const clang::CFGBlock*> &analyzed,
-    std::vector<CFGBlock*> &controlDependencyGraphNodes,
-    clang::ASTContext &astContext,
-    ExprSymbolizer &exprSymbolizer
-  ) {
-    std::vector<CFGBlock*> predecessors;
-    if (block == nullptr || block->pred_empty() || llvm::is_contained(analyzed, block)) {
-      return predecessors;
-    }
-    analyzed.push_back(block);
-    
-    llvm::outs() << "buildGraph for: ";
-    block->dump();
-    llvm::outs() << "\n";
+    // the dependencies are copied, since connecting them may compute the dependencies of other blocks
+    llvm::SmallVector<clang::CFGBlock *, 4> deps = controlDependencies.getControlDependencies(
+      const_cast<clang::CFGBlock *>(block)
+    );
+    for (auto const *depBlock : deps) {
+      assert(depBlock != nullptr);
+      // a dependency that doesn't precede this block is reached through a back edge
+      if (!comesBefore(depBlock, block)) {
+        continue;
+      }
+      // ignore blocks that come after this block (e.g., the head of the enclosing loop), and
+      // blocks within the loop that this block heads, which would otherwise form cycles
+      if (postdominatorAnalysis.dominates(depBlock, block) && !dominatorAnalysis.dominates(depBlock, block)) {
+        continue;
+      }
+      if (dominatorAnalysis.dominates(block, depBlock)) {
+        continue;
+      }
 
-    // Recursively build the graph for the block's predecessors
-    for (const clang::CFGBlock::AdjacentBlock predecessorBlock: block->preds()) {
-      auto indirectPredecessors = buildGraph(
-        false,
-        predecessorBlock.getReachableBlock(),
-        deps,
-        postdominatorAnalysis,
-        dominatorAnalysis,
-        analyzed,
-        controlDependencyGraphNodes,
-        astContext,
-        exprSymbolizer
-      );
-      predecessors.insert(predecessors.end(), indirectPredecessors.begin(), indirectPredecessors.end()); //merge results
+      auto type = getEdgeType(depBlock, block);
+      if (!type.hasValue()) {
+        continue;
+      }
+      if (getBlock(depBlock)->createEdge(node, type.getValue())) {
+        Log::outs()
+          << "created edge between B" << depBlock->getBlockID()
+          << " and B" << id
+          << " of type " << CFGEdge::getEdgeTypeName(type.getValue()) << "\n";
+      }
     }
+    return node;
+  }
 
-    // Create a node for control dependencies and the first block
-    if (first || llvm::is_contained(deps, block)) {
-      auto newControlDependencyNode = this->getBlock(block);
-      assert(newControlDependencyNode != nullptr);
-
-      // Create edges for predecessors
-      for (auto *predecessor: predecessors) {
-        assert(predecessor != nullptr);
-        assert(predecessor->getClangBlock() != nullptr);
-        // Check all nodes of the control dependency graph for potential edges to be created and their type
-        for(auto *depBlock : controlDependencyGraphNodes) {
-          assert(depBlock != nullptr);
-
-          bool trueBranchDominates = false;
-          bool falseBranchDominates = false;
+private:
+  clang::ControlDependencyCalculator &controlDependencies;
+  clang::CFGDominatorTreeImpl<true> &postdominatorAnalysis;
+  clang::CFGDominatorTreeImpl<false> &dominatorAnalysis;
+  // true if the first block comes before the second in reverse postorder
+  clang::PostOrderCFGView::BlockOrderCompare comesBefore;
+  std::unordered_map<long, std::unique_ptr<CFGBlock>> idToBlockDict; //maps BlockID to CFGBlockObject
 
-          int i = 0;
-          for (const clang::CFGBlock *sBlock: predecessor->getClangBlock()->succs()) {
-            // The only post-dominating control dependency is the directly following control dependency,
-            // The exception to this is the head of a loop, which is the only control dependency which then also pre-dominiates the 
-            // inner statement. Hence those edges need to be ignored to avoid circles in the control dependcy graph. 
-            if ((postdominatorAnalysis.dominates(depBlock->getClangBlock(), sBlock) 
-              && !dominatorAnalysis.dominates(depBlock->getClangBlock(), sBlock)) 
-              || depBlock->getClangBlock()->getBlockID() == sBlock->getBlockID()) {
-              if (i == 0) { //true branch, as defined by clang's order of successors                
-                  llvm::outs() << "true branch dominates stmt\n";
-                  trueBranchDominates = true;
-              } else if (i == 1) { //false branch
-                  llvm::outs() << "false branch dominates stmt\n";
-                  falseBranchDominates = true;
-              } 
-            } 
-            if (i > 1) {
-              //TODO: Handle switch-case here.
-              llvm::outs() << "Too many branches. Switch not yet supported\n";
-              abort();
-            }
-            i++;
-          }
-          if (!trueBranchDominates && !falseBranchDominates) {
-            continue; // No edge needed
-          }
-          if (trueBranchDominates && falseBranchDominates){
-            llvm::outs() << "ERROR: falseBranchDominates: " << falseBranchDominates << " trueBranchDominates: " << trueBranchDominates << "\n";
-            llvm::outs() << "depBlock->getClangBlock(): ";
-            depBlock->getClangBlock()->dump();
-            llvm::outs() << "\npredecessor->getClangBlock(): ";
-            predecessor->getClangBlock()->dump();
-            abort();
-          }
-          
-          // Creating edge
-          CFGEdge::EdgeType type;
-          if (i == 1) {
-            type = CFGEdge::EdgeType::Normal;
-          } else if (i == 2) {
-            type = falseBranchDominates ? CFGEdge::EdgeType::False : CFGEdge::EdgeType::True;
-          } else {
-            type = CFGEdge::EdgeType::Unknown;
-            llvm::outs() << "ERROR: Unknown edge type\n";
-          }
+  /** Returns the branch of a given block that leads to another block, if only one of them does. */
+  llvm::Optional<CFGEdge::EdgeType> getEdgeType(const clang::CFGBlock* predecessor, const clang::CFGBlock* block) {
+    bool trueBranchDominates = false;
+    bool falseBranchDominates = false;
 
-          if (predecessor->createEdge(depBlock, type)) {
-            llvm::outs() << "created edge between " << predecessor->getConditionStr(astContext, exprSymbolizer) << " and " << depBlock->getConditionStr(astContext, exprSymbolizer) << " of type " << CFGEdge::getEdgeTypeName(type) << "\n";
-          }
+    int i = 0;
+    for (const clang::CFGBlock *sBlock: predecessor->succs()) {
+      // The only post-dominating control dependency is the directly following control dependency,
+      // The exception to this is the head of a loop, which is the only control dependency which then also pre-dominiates the
+      // inner statement. Hence those edges need to be ignored to avoid circles in the control dependcy graph.
+      if (sBlock != nullptr && (
+            (postdominatorAnalysis.dominates(block, sBlock) && !dominatorAnalysis.dominates(block, sBlock))
+         || block->getBlockID() == sBlock->getBlockID())) {
+        if (i == 0) { //true branch, as defined by clang's order of successors
+          trueBranchDominates = true;
+        } else if (i == 1) { //false branch
+          falseBranchDominates = true;
         }
       }
-      return {newControlDependencyNode}; // Return newly created control dependency node
-    } else { 
-      return predecessors; // For non-control dependency nodes forward the predecessors to the next dependency node
+      if (i > 1) {
+        //TODO: Handle switch-case here.
+        Log::outs() << "Too many branches. Switch not yet supported\n";
+        abort();
+      }
+      i++;
+    }
+    if (!trueBranchDominates && !falseBranchDominates) {
+      return llvm::None; // No edge needed
+    }
+    if (trueBranchDominates && falseBranchDominates) {
+      Log::outs()
+        << "ERROR: both branches of B" << predecessor->getBlockID()
+        << " lead to B" << block->getBlockID() << "\n";
+      abort();
+    }
+
+    if (i == 1) {
+      return CFGEdge::EdgeType::Normal;
+    } else if (i == 2) {
+      return falseBranchDominates ? CFGEdge::EdgeType::False : CFGEdge::EdgeType::True;
     }
+    Log::outs() << "ERROR: Unknown edge type\n";
+    return CFGEdge::EdgeType::Unknown;
   }
-  
 };
 } // rosdiscover
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <memory>
+
+#include <clang/AST/ASTContext.h>
+#include <clang/AST/Decl.h>
+#include <clang/AST/ParentMap.h>
+#include <clang/AST/Stmt.h>
+#include <clang/Analysis/Analyses/Dominators.h>
+#include <clang/Analysis/Analyses/PostOrderCFGView.h>
+#include <clang/Analysis/CFG.h>
+#include <clang/Analysis/CFGStmtMap.h>
+
+#include "../Helper/ASTContextLock.h"
+#include "ControlDependenceGraph.h"
+
+namespace rosdiscover {
+
+/**
+ * Owns the CFG of a single function, along with the analyses over that CFG that are needed to
+ * compute the control dependencies of its statements, and the control dependence graph that they
+ * induce. Everything is built once, when it is first needed, and is then shared by all statements
+ * of the function.
+ */
+class FunctionCFGAnalysis {
+public:
+  FunctionCFGAnalysis(clang::FunctionDecl const *function, clang::ASTContext &astContext)
+    : function(function),
+      astContext(astContext),
+      isBuilt(false),
+      cfg(),
+      parentMap(),
+      stmtMap(),
+      controlDependencies(),
+      postDominatorTree(),
+      dominatorTree(),
+      postOrder(),
+      controlDependenceGraph()
+  {}
+
+  clang::CFG & getCFG() {
+    build();
+    return *cfg;
+  }
+
+  /** Returns the CFG block that contains a given statement, or nullptr if there is none. */
+  clang::CFGBlock const * getBlock(clang::Stmt const *stmt) {
+    build();
+    if (stmtMap == nullptr) {
+      return nullptr;
+    }
+    return static_cast<clang::CFGStmtMap const &>(*stmtMap).getBlock(stmt);
+  }
+
+  clang::CFGDominatorTreeImpl<true> & getPostDominatorTree() {
+    build();
+    return *postDominatorTree;
+  }
+
+  clang::CFGDominatorTreeImpl<false> & getDominatorTree() {
+    build();
+    return *dominatorTree;
+  }
+
+  ControlDependenceGraph & getControlDependenceGraph() {
+    build();
+    return *controlDependenceGraph;
+  }
+
+private:
+  clang::FunctionDecl const *function;
+  clang::ASTContext &astContext;
+  bool isBuilt;
+  std::unique_ptr<clang::CFG> cfg;
+  std::unique_ptr<clang::ParentMap> parentMap;
+  std::unique_ptr<clang::CFGStmtMap> stmtMap;
+  std::unique_ptr<clang::ControlDependencyCalculator> controlDependencies;
+  std::unique_ptr<clang::CFGDominatorTreeImpl<true>> postDominatorTree;
+  std::unique_ptr<clang::CFGDominatorTreeImpl<false>> dominatorTree;
+  std::unique_ptr<clang::PostOrderCFGView> postOrder;
+  std::unique_ptr<ControlDependenceGraph> controlDependenceGraph;
+
+  void build() {
+    if (isBuilt) {
+      return;
+    }
+    isBuilt = true;
+    {
+      // CFG construction evaluates conditions, which may update state cached by the ASTContext
+      ASTContextLock lock;
+      cfg = clang::CFG::buildCFG(function, function->getBody(), &astContext, clang::CFG::BuildOptions());
+    }
+    if (cfg == nullptr) {
+      return;
+    }
+    parentMap = std::make_unique<clang::ParentMap>(function->getBody());
+    stmtMap.reset(clang::CFGStmtMap::Build(cfg.get(), parentMap.get()));
+    controlDependencies = std::make_unique<clang::ControlDependencyCalculator>(cfg.get());
+    postDominatorTree = std::make_unique<clang::CFGDominatorTreeImpl<true>>(cfg.get());
+    dominatorTree = std::make_unique<clang::CFGDominatorTreeImpl<false>>(cfg.get());
+    postOrder = std::make_unique<clang::PostOrderCFGView>(cfg.get());
+    controlDependenceGraph = std::make_unique<ControlDependenceGraph>(
+      *controlDependencies,
+      *postDominatorTree,
+      *dominatorTree,
+      *postOrder
+    );
+  }
+};
+
+} // rosdiscover
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <clang/Basic/Diagnostic.h>
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <clang/Tooling/Tooling.h>
+#include <llvm/ADT/Optional.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/VirtualFileSystem.h>
+
+#include "ASTCache.h"
+#include "CompileCommands.h"
+#include "SharedPreambles.h"
+
+namespace rosdiscover {
+
+/**
+ * Builds an ASTUnit for each compiler invocation that it is given.
+ * The ASTs outlive the tool that creates them, so each AST owns its own diagnostic consumer,
+ * which ignores all diagnostics.
+ */
+class ASTBuilderAction : public clang::tooling::ToolAction {
+public:
+  ASTBuilderAction(std::vector<std::unique_ptr<clang::ASTUnit>> &asts) : asts(asts) {}
+
+  bool runInvocation(
+      std::shared_ptr<clang::CompilerInvocation> invocation,
+      clang::FileManager *files,
+      std::shared_ptr<clang::PCHContainerOperations> pchContainerOps,
+      clang::DiagnosticConsumer *diagConsumer
+  ) override {
+    auto ast = clang::ASTUnit::LoadFromCompilerInvocation(
+      invocation,
+      std::move(pchContainerOps),
+      clang::CompilerInstance::createDiagnostics(
+        &invocation->getDiagnosticOpts(),
+        new clang::IgnoringDiagConsumer(),
+        /*ShouldOwnClient=*/true
+      ),
+      files
+    );
+    if (!ast) {
+      return false;
+    }
+    asts.push_back(std::move(ast));
+    return true;
+  }
+
+private:
+  std::vector<std::unique_ptr<clang::ASTUnit>> &asts;
+};
+
+/**
+ * Parses a list of compile commands into ASTs, optionally using a pool of worker threads.
+ * The resulting ASTs are always returned in the same order as the compile commands.
+ * If an AST cache is given, ASTs are loaded from it where possible, and freshly parsed
+ * ASTs are written back to it. If shared preambles are given, each compile command is
+ * parsed with its preamble, falling back to a full parse if the preamble can't be used.
+ */
+class ASTBuilder {
+public:
+  static std::vector<std::unique_ptr<clang::ASTUnit>> build(
+      std::vector<clang::tooling::CompileCommand> const &commands,
+      unsigned numJobs,
+      ASTCache const *cache = nullptr,
+      SharedPreambles const *preambles = nullptr
+  ) {
+    // each compile command writes to its own slot, which keeps the output order stable
+    std::vector<std::vector<std::unique_ptr<clang::ASTUnit>>> results(commands.size());
+    Statistics statistics;
+
+    if (numJobs == 1 || commands.size() <= 1) {
+      for (size_t i = 0; i < commands.size(); ++i) {
+        results[i] = buildOne(commands[i], cache, preambles, statistics);
+      }
+    } else {
+      llvm::ThreadPool pool(llvm::hardware_concurrency(numJobs));
+      for (size_t i = 0; i < commands.size(); ++i) {
+        pool.async([&commands, &results, &statistics, cache, preambles, i] {
+          results[i] = buildOne(commands[i], cache, preambles, statistics);
+        });
+      }
+      pool.wait();
+    }
+
+    if (cache != nullptr) {
+      llvm::outs()
+        << "loaded " << statistics.numCacheHits.load() << " of " << commands.size()
+        << " ASTs from the AST cache\n";
+    }
+    if (preambles != nullptr) {
+      llvm::outs()
+        << "parsed " << statistics.numPreambleHits.load() << " of " << commands.size()
+        << " translation units with a shared preamble ("
+        << statistics.numPreambleFallbacks.load() << " fell back to a full parse)\n";
+    }
+
+    std::vector<std::unique_ptr<clang::ASTUnit>> asts;
+    for (size_t i = 0; i < commands.size(); ++i) {
+      if (results[i].empty()) {
+        llvm::errs() << "WARNING: failed to build AST for file: " << commands[i].Filename << "\n";
+      }
+      for (auto &ast : results[i]) {
+        asts.push_back(std::move(ast));
+      }
+    }
+    return asts;
+  }
+
+private:
+  struct Statistics {
+    std::atomic<size_t> numCacheHits{0};
+    std::atomic<size_t> numPreambleHits{0};
+    std::atomic<size_t> numPreambleFallbacks{0};
+  };
+
+  static std::vector<std::unique_ptr<clang::ASTUnit>> buildOne(
+      clang::tooling::CompileCommand const &command,
+      ASTCache const *cache,
+      SharedPreambles const *preambles,
+      Statistics &statistics
+  ) {
+    std::vector<std::unique_ptr<clang::ASTUnit>> asts;
+    if (cache != nullptr) {
+      if (auto ast = cache->load(command)) {
+        statistics.numCacheHits++;
+        asts.push_back(std::move(ast));
+        return asts;
+      }
+    }
+
+    // a preamble that doesn't match the compile command causes a fatal error, in which
+    // case we discard the AST and parse the translation unit from scratch
+    std::vector<std::string> extraDependencies;
+    llvm::Optional<std::string> preamble;
+    if (preambles != nullptr) {
+      preamble = preambles->getPreamble(command);
+    }
+    if (preamble) {
+      asts = parse(SharedPreambles::withPreamble(command, *preamble));
+      bool failed = asts.empty();
+      for (auto const &ast : asts) {
+        failed = failed || ast->getDiagnostics().hasFatalErrorOccurred();
+      }
+      if (failed) {
+        statistics.numPreambleFallbacks++;
+        asts.clear();
+      } else {
+        statistics.numPreambleHits++;
+        extraDependencies.push_back(*preamble);
+      }
+    }
+    if (asts.empty()) {
+      asts = parse(command);
+    }
+
+    if (cache != nullptr) {
+      for (auto &ast : asts) {
+        cache->store(command, *ast, extraDependencies);
+      }
+    }
+    return asts;
+  }
+
+  static std::vector<std::unique_ptr<clang::ASTUnit>> parse(clang::tooling::CompileCommand const &command) {
+    std::vector<std::unique_ptr<clang::ASTUnit>> asts;
+    SingleCommandCompilationDatabase database(command);
+    clang::IgnoringDiagConsumer diagConsumer;
+
+    // ClangTool changes the working directory of its file system to the directory of the
+    // compile command. We give each tool its own physical file system so that concurrent
+    // tools do not change the working directory of the whole process.
+    clang::tooling::ClangTool tool(
+      database,
+      {command.Filename},
+      std::make_shared<clang::PCHContainerOperations>(),
+      llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem>(llvm::vfs::createPhysicalFileSystem().release())
+    );
+    tool.setDiagnosticConsumer(&diagConsumer);
+
+    ASTBuilderAction action(asts);
+    tool.run(&action);
+    return asts;
+  }
+};
+
+} // rosdiscover
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <clang/Basic/Diagnostic.h>
+#include <clang/Basic/DiagnosticOptions.h>
+#include <clang/Basic/FileSystemOptions.h>
+#include <clang/Basic/SourceManager.h>
+#include <clang/Basic/Version.h>
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Serialization/PCHContainerOperations.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "DependencyFile.h"
+
+namespace rosdiscover {
+
+/**
+ * A persistent, on-disk cache of serialized ASTs.
+ *
+ * Each entry belongs to a single compile command and consists of two files:
+ * - <key>.ast holds the serialized AST, and
+ * - <key>.deps is a DependencyFile for every file that was read while parsing.
+ *
+ * The key is a hash of the compile command and the version of Clang. An entry is only used
+ * if all of its dependencies are still up to date.
+ */
+class ASTCache {
+public:
+  ASTCache(std::string const &directory) : directory(directory) {
+    if (auto error = llvm::sys::fs::create_directories(directory)) {
+      llvm::errs()
+        << "WARNING: failed to create AST cache directory ["
+        << directory << "]: " << error.message() << "\n";
+    }
+  }
+
+  /** Returns the cached AST for a given compile command, or a null pointer if there is no valid entry. */
+  std::unique_ptr<clang::ASTUnit> load(clang::tooling::CompileCommand const &command) const {
+    auto key = getCommandKey(command);
+    auto astPath = getEntryPath(key, "ast");
+    if (!llvm::sys::fs::exists(astPath) || !DependencyFile::isUpToDate(getEntryPath(key, "deps"))) {
+      return nullptr;
+    }
+
+    // the reader is referenced by the loaded AST for as long as it lives
+    static clang::RawPCHContainerReader const pchContainerReader;
+    clang::FileSystemOptions fileSystemOptions;
+    fileSystemOptions.WorkingDir = command.Directory;
+    return clang::ASTUnit::LoadFromASTFile(
+      astPath,
+      pchContainerReader,
+      clang::ASTUnit::LoadEverything,
+      clang::CompilerInstance::createDiagnostics(
+        new clang::DiagnosticOptions(),
+        new clang::IgnoringDiagConsumer(),
+        /*ShouldOwnClient=*/true
+      ),
+      fileSystemOptions,
+      /*UseDebugInfo=*/false,
+      /*OnlyLocalDecls=*/false,
+      llvm::None,
+      clang::CaptureDiagsKind::None,
+      /*AllowPCHWithCompilerErrors=*/true
+    );
+  }
+
+  /**
+   * Writes the AST for a given compile command to the cache. Files that the AST depends on, but
+   * that aren't tracked by its source manager (e.g., a precompiled preamble), can be given as
+   * extra dependencies.
+   */
+  void store(
+      clang::tooling::CompileCommand const &command,
+      clang::ASTUnit &ast,
+      std::vector<std::string> const &extraDependencies = {}
+  ) const {
+    auto key = getCommandKey(command);
+
+    std::vector<std::string> dependencies(extraDependencies);
+    auto const &sourceManager = ast.getSourceManager();
+    for (auto it = sourceManager.fileinfo_begin(); it != sourceManager.fileinfo_end(); ++it) {
+      dependencies.push_back(DependencyFile::getAbsolutePath(command.Directory, it->first));
+    }
+
+    // ASTUnit::Save returns true on failure
+    // the dependency file is written last, which ensures that an entry is never considered
+    // valid before its AST has been completely written
+    if (ast.Save(getEntryPath(key, "ast"))
+     || !DependencyFile::write(getEntryPath(key, "deps"), dependencies)) {
+      llvm::errs() << "WARNING: failed to write AST cache entry: " << command.Filename << "\n";
+    }
+  }
+
+private:
+  std::string directory;
+
+  std::string getEntryPath(std::string const &key, char const *extension) const {
+    llvm::SmallString<256> path(directory);
+    llvm::sys::path::append(path, key + "." + extension);
+    return path.str().str();
+  }
+
+  /** Computes a hash of the compile command and the Clang version that is used to parse it. */
+  static std::string getCommandKey(clang::tooling::CompileCommand const &command) {
+    llvm::MD5 hasher;
+    hasher.update(clang::getClangFullVersion());
+    hasher.update(llvm::StringRef("\0", 1));
+    hasher.update(command.Directory);
+    hasher.update(llvm::StringRef("\0", 1));
+    hasher.update(command.Filename);
+    for (auto const &argument : command.CommandLine) {
+      hasher.update(llvm::StringRef("\0", 1));
+      hasher.update(argument);
+    }
+    llvm::MD5::MD5Result result;
+    hasher.final(result);
+    return result.digest().str().str();
+  }
+};
+
+} // rosdiscover
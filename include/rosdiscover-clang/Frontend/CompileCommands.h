@@ -0,0 +1,89 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <clang/Tooling/CompilationDatabase.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "DependencyFile.h"
+
+namespace rosdiscover {
+
+/** Determines which command is kept when a source file has several compile commands. */
+enum class DuplicateCommandPolicy {
+  KeepFirst,
+  KeepLast
+};
+
+/** A compilation database that provides exactly one compile command. */
+class SingleCommandCompilationDatabase : public clang::tooling::CompilationDatabase {
+public:
+  SingleCommandCompilationDatabase(clang::tooling::CompileCommand const &command)
+    : command(command)
+  {}
+
+  std::vector<clang::tooling::CompileCommand> getCompileCommands(llvm::StringRef filePath) const override {
+    return {command};
+  }
+
+  std::vector<std::string> getAllFiles() const override {
+    return {command.Filename};
+  }
+
+private:
+  clang::tooling::CompileCommand command;
+};
+
+class CompileCommandDeduplicator {
+public:
+  /**
+   * Removes all but one compile command for each source file before any parsing takes place.
+   * The same source file may be compiled multiple times for different CMake build targets, but
+   * we only ever analyze one AST per source file. Skipped commands are reported to stdout.
+   */
+  static std::vector<clang::tooling::CompileCommand> deduplicate(
+      std::vector<clang::tooling::CompileCommand> const &commands,
+      DuplicateCommandPolicy policy
+  ) {
+    // find the index of the command that should be kept for each source file
+    std::unordered_map<std::string, size_t> sourceFileToCommand;
+    for (size_t i = 0; i < commands.size(); ++i) {
+      auto sourceFile = getSourceFilePath(commands[i]);
+      auto it = sourceFileToCommand.find(sourceFile);
+      if (it == sourceFileToCommand.end()) {
+        sourceFileToCommand.emplace(sourceFile, i);
+      } else if (policy == DuplicateCommandPolicy::KeepLast) {
+        it->second = i;
+      }
+    }
+
+    std::vector<clang::tooling::CompileCommand> deduplicated;
+    for (size_t i = 0; i < commands.size(); ++i) {
+      auto const &command = commands[i];
+      auto sourceFile = getSourceFilePath(command);
+      if (sourceFileToCommand[sourceFile] == i) {
+        deduplicated.push_back(command);
+        continue;
+      }
+
+      llvm::outs()
+        << "skipping duplicate compile command for: " << sourceFile
+        << " [directory: " << command.Directory;
+      if (!command.Output.empty()) {
+        llvm::outs() << "; output: " << command.Output;
+      }
+      llvm::outs() << "]\n";
+    }
+
+    return deduplicated;
+  }
+
+  /** Returns the normalized, absolute path of the source file that is compiled by a given command. */
+  static std::string getSourceFilePath(clang::tooling::CompileCommand const &command) {
+    return DependencyFile::getAbsolutePath(command.Directory, command.Filename);
+  }
+};
+
+} // rosdiscover
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <clang/Basic/FileManager.h>
+#include <llvm/ADT/Optional.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace rosdiscover {
+
+/**
+ * Records the files that a cached artifact was built from.
+ *
+ * A dependency file holds a hash of the paths and contents of all dependencies on its first line,
+ * followed by one dependency path per line. An artifact is up to date for as long as the current
+ * contents of its dependencies still produce the same hash.
+ */
+class DependencyFile {
+public:
+  /** Atomically writes a dependency file for a given list of absolute paths. Returns true on success. */
+  static bool write(std::string const &path, std::vector<std::string> dependencies) {
+    std::sort(dependencies.begin(), dependencies.end());
+    dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+
+    auto dependenciesHash = hash(dependencies);
+    if (!dependenciesHash) {
+      return false;
+    }
+
+    int fd;
+    llvm::SmallString<256> temporaryPath;
+    if (llvm::sys::fs::createUniqueFile(path + "-%%%%%%%%", fd, temporaryPath)) {
+      return false;
+    }
+    {
+      llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+      os << *dependenciesHash << "\n";
+      for (auto const &dependency : dependencies) {
+        os << dependency << "\n";
+      }
+    }
+    if (llvm::sys::fs::rename(temporaryPath, path)) {
+      llvm::sys::fs::remove(temporaryPath);
+      return false;
+    }
+    return true;
+  }
+
+  /** Determines whether the dependencies recorded in a given file still have the same contents. */
+  static bool isUpToDate(std::string const &path) {
+    auto buffer = llvm::MemoryBuffer::getFile(path);
+    if (!buffer) {
+      return false;
+    }
+
+    llvm::SmallVector<llvm::StringRef, 64> lines;
+    (*buffer)->getBuffer().split(lines, '\n', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+    if (lines.empty()) {
+      return false;
+    }
+
+    std::vector<std::string> dependencies;
+    for (size_t i = 1; i < lines.size(); ++i) {
+      dependencies.push_back(lines[i].str());
+    }
+    auto dependenciesHash = hash(dependencies);
+    return dependenciesHash && *dependenciesHash == lines[0];
+  }
+
+  /** Returns the normalized, absolute path of a file, resolving relative paths against a given directory. */
+  static std::string getAbsolutePath(llvm::StringRef directory, llvm::StringRef filename) {
+    llvm::SmallString<256> path(filename);
+    if (!llvm::sys::path::is_absolute(path)) {
+      path = directory;
+      llvm::sys::path::append(path, filename);
+    }
+    llvm::sys::path::remove_dots(path, /*remove_dot_dot=*/true);
+    return path.str().str();
+  }
+
+  static std::string getAbsolutePath(llvm::StringRef directory, clang::FileEntry const *file) {
+    auto realPath = file->tryGetRealPathName();
+    return getAbsolutePath(directory, realPath.empty() ? file->getName() : realPath);
+  }
+
+private:
+  /** Hashes the paths and current contents of a list of files, or returns None if a file can't be read. */
+  static llvm::Optional<std::string> hash(std::vector<std::string> const &dependencies) {
+    llvm::MD5 hasher;
+    for (auto const &dependency : dependencies) {
+      auto buffer = llvm::MemoryBuffer::getFile(dependency);
+      if (!buffer) {
+        return llvm::None;
+      }
+      hasher.update(dependency);
+      hasher.update(llvm::StringRef("\0", 1));
+      hasher.update((*buffer)->getBuffer());
+      hasher.update(llvm::StringRef("\0", 1));
+    }
+    llvm::MD5::MD5Result result;
+    hasher.final(result);
+    return result.digest().str().str();
+  }
+};
+
+} // rosdiscover
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <clang/Tooling/CompilationDatabase.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "CompileCommands.h"
+#include "DependencyFile.h"
+
+namespace rosdiscover {
+
+/**
+ * A cheap, textual pre-pass that finds translation units that are unlikely to call the ROS API.
+ *
+ * A translation unit is kept if its source file, or one of the project headers that it
+ * (transitively) includes, mentions one of a handful of tokens. Headers are resolved against the
+ * directory of the including file and the -I and -iquote directories of the compile command;
+ * headers in system include directories are never scanned.
+ *
+ * The filter is a heuristic and may drop translation units that do use the API: a call that is
+ * made through a wrapper that is declared in a header outside of the include directories above
+ * (or that is reached through a macro, or an include that is computed) goes unnoticed. It is
+ * therefore only used when requested explicitly.
+ */
+class RosApiPrefilter {
+public:
+  /** Removes all compile commands whose translation units don't mention the ROS API. */
+  std::vector<clang::tooling::CompileCommand> filter(
+      std::vector<clang::tooling::CompileCommand> const &commands
+  ) {
+    std::vector<clang::tooling::CompileCommand> kept;
+    for (auto const &command : commands) {
+      if (mayUseRosApi(command)) {
+        kept.push_back(command);
+      } else {
+        llvm::outs()
+          << "skipping translation unit without ROS API usage: "
+          << CompileCommandDeduplicator::getSourceFilePath(command) << "\n";
+      }
+    }
+    return kept;
+  }
+
+  /** Determines whether the translation unit of a given compile command may use the ROS API. */
+  bool mayUseRosApi(clang::tooling::CompileCommand const &command) {
+    auto includeDirectories = getIncludeDirectories(command);
+    std::vector<std::string> queue = {CompileCommandDeduplicator::getSourceFilePath(command)};
+    std::unordered_set<std::string> visited(queue.begin(), queue.end());
+
+    while (!queue.empty()) {
+      auto path = queue.back();
+      queue.pop_back();
+
+      auto const &file = scan(path);
+      if (file.mentionsRosApi) {
+        return true;
+      }
+
+      auto directory = llvm::sys::path::parent_path(path);
+      for (auto const &include : file.includes) {
+        auto header = resolveInclude(include, directory, includeDirectories);
+        if (!header.empty() && visited.insert(header).second) {
+          queue.push_back(header);
+        }
+      }
+    }
+    return false;
+  }
+
+private:
+  struct ScannedFile {
+    bool mentionsRosApi = false;
+    std::vector<std::string> includes;
+  };
+
+  /** Results are shared between translation units, since they tend to include the same headers. */
+  std::unordered_map<std::string, ScannedFile> scannedFiles;
+
+  /** Scans a file for ROS API tokens and the names of the files that it includes. */
+  ScannedFile const &scan(std::string const &path) {
+    auto it = scannedFiles.find(path);
+    if (it != scannedFiles.end()) {
+      return it->second;
+    }
+
+    ScannedFile &file = scannedFiles[path];
+    auto buffer = llvm::MemoryBuffer::getFile(path);
+    if (!buffer) {
+      // we can't rule out a file that we can't read
+      file.mentionsRosApi = true;
+      return file;
+    }
+
+    llvm::StringRef contents = (*buffer)->getBuffer();
+    for (llvm::StringRef token : {"ros::", "ros/", "namespace ros", "NodeHandle", "message_filters"}) {
+      if (contents.find(token) != llvm::StringRef::npos) {
+        file.mentionsRosApi = true;
+        return file;
+      }
+    }
+
+    llvm::SmallVector<llvm::StringRef, 128> lines;
+    contents.split(lines, '\n');
+    for (auto line : lines) {
+      line = line.trim();
+      if (!line.consume_front("#")) {
+        continue;
+      }
+      line = line.ltrim();
+      if (!line.consume_front("include")) {
+        continue;
+      }
+      line = line.ltrim();
+      if (line.size() < 2 || (line.front() != '"' && line.front() != '<')) {
+        continue;
+      }
+      char terminator = line.front() == '"' ? '"' : '>';
+      auto name = line.drop_front().take_until([terminator](char c) { return c == terminator; });
+      if (!name.empty()) {
+        file.includes.push_back(name.str());
+      }
+    }
+    return file;
+  }
+
+  /** Returns the directories that are searched for project headers by a given compile command. */
+  static std::vector<std::string> getIncludeDirectories(clang::tooling::CompileCommand const &command) {
+    std::vector<std::string> directories;
+    auto const &arguments = command.CommandLine;
+    for (size_t i = 0; i < arguments.size(); ++i) {
+      llvm::StringRef argument(arguments[i]);
+      for (llvm::StringRef option : {"-iquote", "-I"}) {
+        if (!argument.startswith(option)) {
+          continue;
+        }
+        auto directory = argument.drop_front(option.size());
+        if (directory.empty() && i + 1 < arguments.size()) {
+          directory = arguments[++i];
+        }
+        if (!directory.empty()) {
+          directories.push_back(DependencyFile::getAbsolutePath(command.Directory, directory));
+        }
+        break;
+      }
+    }
+    return directories;
+  }
+
+  /** Returns the path of an included file, or an empty string if it isn't a project header. */
+  static std::string resolveInclude(
+      std::string const &include,
+      llvm::StringRef includingDirectory,
+      std::vector<std::string> const &includeDirectories
+  ) {
+    auto candidate = DependencyFile::getAbsolutePath(includingDirectory, include);
+    if (llvm::sys::fs::is_regular_file(candidate)) {
+      return candidate;
+    }
+    for (auto const &directory : includeDirectories) {
+      candidate = DependencyFile::getAbsolutePath(directory, include);
+      if (llvm::sys::fs::is_regular_file(candidate)) {
+        return candidate;
+      }
+    }
+    return "";
+  }
+};
+
+} // rosdiscover
@@ -0,0 +1,402 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <clang/Basic/Diagnostic.h>
+#include <clang/Basic/Version.h>
+#include <clang/Driver/Options.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/CompilerInvocation.h>
+#include <clang/Frontend/FrontendActions.h>
+#include <clang/Frontend/Utils.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <clang/Tooling/Tooling.h>
+#include <llvm/ADT/Optional.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Option/Arg.h>
+#include <llvm/Option/ArgList.h>
+#include <llvm/Option/OptTable.h>
+#include <llvm/Option/Option.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "CompileCommands.h"
+#include "DependencyFile.h"
+
+namespace rosdiscover {
+
+/** Records every file that is read while building a precompiled header, including system headers. */
+class PreambleDependencyCollector : public clang::DependencyCollector {
+public:
+  bool needSystemDependencies() override {
+    return true;
+  }
+};
+
+/**
+ * Generates a precompiled header for a single compiler invocation and records its dependencies.
+ * This mirrors FrontendActionFactory::runInvocation, but also attaches a dependency collector.
+ */
+class PreambleBuilderAction : public clang::tooling::ToolAction {
+public:
+  PreambleBuilderAction(std::shared_ptr<PreambleDependencyCollector> dependencies)
+    : dependencies(dependencies)
+  {}
+
+  bool runInvocation(
+      std::shared_ptr<clang::CompilerInvocation> invocation,
+      clang::FileManager *files,
+      std::shared_ptr<clang::PCHContainerOperations> pchContainerOps,
+      clang::DiagnosticConsumer *diagConsumer
+  ) override {
+    clang::CompilerInstance compiler(std::move(pchContainerOps));
+    compiler.setInvocation(std::move(invocation));
+    compiler.setFileManager(files);
+    compiler.createDiagnostics(diagConsumer, /*ShouldOwnClient=*/false);
+    if (!compiler.hasDiagnostics()) {
+      return false;
+    }
+    compiler.createSourceManager(*files);
+    compiler.addDependencyCollector(dependencies);
+
+    clang::GeneratePCHAction action;
+    bool success = compiler.ExecuteAction(action);
+    files->clearStatCache();
+    return success && !compiler.getDiagnostics().hasErrorOccurred();
+  }
+
+private:
+  std::shared_ptr<PreambleDependencyCollector> dependencies;
+};
+
+/**
+ * Builds precompiled headers for the include prefix that is shared by several translation units.
+ *
+ * Compile commands are grouped by their flags. Within each group, we find the longest run of
+ * leading #include <...> directives that every source file starts with (typically ros/ros.h,
+ * message headers, and Boost), and precompile that prefix once. Each translation unit in the
+ * group is then parsed with -include-pch, which skips the bulk of the shared headers.
+ *
+ * Preambles are stored alongside a DependencyFile and are reused between runs if they are kept
+ * in a persistent directory. Otherwise, they are written to a temporary directory that is removed
+ * when this object is destroyed, so it must outlive every AST that was built with a preamble.
+ */
+class SharedPreambles {
+public:
+  /** Stores preambles in a given directory, or in a temporary directory if the given directory is empty. */
+  SharedPreambles(std::string const &directory) : directory(directory), isTemporary(directory.empty()) {
+    if (isTemporary) {
+      llvm::SmallString<256> temporaryDirectory;
+      if (auto error = llvm::sys::fs::createUniqueDirectory("rosdiscover-preambles", temporaryDirectory)) {
+        llvm::errs() << "WARNING: failed to create temporary preamble directory: " << error.message() << "\n";
+      }
+      this->directory = temporaryDirectory.str().str();
+    } else if (auto error = llvm::sys::fs::create_directories(directory)) {
+      llvm::errs()
+        << "WARNING: failed to create preamble directory ["
+        << directory << "]: " << error.message() << "\n";
+    }
+  }
+
+  ~SharedPreambles() {
+    if (isTemporary && !directory.empty()) {
+      llvm::sys::fs::remove_directories(directory);
+    }
+  }
+
+  SharedPreambles(SharedPreambles const &) = delete;
+  SharedPreambles &operator=(SharedPreambles const &) = delete;
+
+  /** Builds (or reuses) a preamble for each group of compile commands that share their flags and include prefix. */
+  void build(std::vector<clang::tooling::CompileCommand> const &commands) {
+    std::map<std::string, std::vector<size_t>> groups;
+    for (size_t i = 0; i < commands.size(); ++i) {
+      groups[getFlagsKey(commands[i])].push_back(i);
+    }
+
+    size_t numPreambles = 0;
+    for (auto const &entry : groups) {
+      auto const &members = entry.second;
+      if (members.size() < 2) {
+        continue;
+      }
+
+      // find the include prefix that is shared by all members of the group
+      auto prefix = findLeadingSystemIncludes(commands[members[0]]);
+      for (size_t i = 1; i < members.size() && !prefix.empty(); ++i) {
+        auto includes = findLeadingSystemIncludes(commands[members[i]]);
+        size_t length = 0;
+        while (length < prefix.size() && length < includes.size() && prefix[length] == includes[length]) {
+          ++length;
+        }
+        prefix.resize(length);
+      }
+      if (prefix.empty()) {
+        continue;
+      }
+
+      auto preamble = buildPreamble(commands[members[0]], entry.first, prefix);
+      if (!preamble) {
+        continue;
+      }
+      numPreambles++;
+      for (auto i : members) {
+        sourceFileToPreamble.emplace(CompileCommandDeduplicator::getSourceFilePath(commands[i]), *preamble);
+      }
+    }
+
+    llvm::outs()
+      << "built " << numPreambles << " shared preambles for "
+      << sourceFileToPreamble.size() << " of " << commands.size() << " compile commands\n";
+  }
+
+  /** Returns the path of the preamble for a given compile command, if there is one. */
+  llvm::Optional<std::string> getPreamble(clang::tooling::CompileCommand const &command) const {
+    auto it = sourceFileToPreamble.find(CompileCommandDeduplicator::getSourceFilePath(command));
+    if (it == sourceFileToPreamble.end()) {
+      return llvm::None;
+    }
+    return it->second;
+  }
+
+  /** Returns a copy of a compile command that uses a given preamble. */
+  static clang::tooling::CompileCommand withPreamble(
+      clang::tooling::CompileCommand const &command,
+      std::string const &preamble
+  ) {
+    auto result = command;
+    auto position = result.CommandLine.begin() + (result.CommandLine.empty() ? 0 : 1);
+    result.CommandLine.insert(position, {"-include-pch", preamble});
+    return result;
+  }
+
+private:
+  std::string directory;
+  bool isTemporary;
+  std::unordered_map<std::string, std::string> sourceFileToPreamble;
+
+  /**
+   * Returns the arguments of a compile command without its main file, output file, and dependency
+   * file options. Arguments are recognized by the driver's option table, so both the separate
+   * (e.g., "-o file") and the joined (e.g., "-ofile") forms of an option are removed, but no other
+   * options that merely share a prefix with them. The main file is recognized regardless of
+   * whether it is given as a relative or as an absolute path.
+   */
+  static std::vector<std::string> getFlags(clang::tooling::CompileCommand const &command) {
+    auto const &arguments = command.CommandLine;
+    if (arguments.empty()) {
+      return {};
+    }
+
+    // the first argument is the compiler itself
+    std::vector<char const *> driverArguments;
+    for (size_t i = 1; i < arguments.size(); ++i) {
+      driverArguments.push_back(arguments[i].c_str());
+    }
+    unsigned missingArgIndex = 0;
+    unsigned missingArgCount = 0;
+    auto parsedArguments = clang::driver::getDriverOptTable().ParseArgs(
+      driverArguments,
+      missingArgIndex,
+      missingArgCount
+    );
+    std::vector<llvm::opt::Arg const *> parsed(parsedArguments.begin(), parsedArguments.end());
+
+    auto mainFile = CompileCommandDeduplicator::getSourceFilePath(command);
+    std::vector<bool> isRemoved(arguments.size(), false);
+    for (size_t k = 0; k < parsed.size(); ++k) {
+      auto const &option = parsed[k]->getOption();
+      bool isRemovedOption =
+           option.matches(clang::driver::options::OPT_o)
+        || option.matches(clang::driver::options::OPT_c)
+        || option.matches(clang::driver::options::OPT_MD)
+        || option.matches(clang::driver::options::OPT_MMD)
+        || option.matches(clang::driver::options::OPT_MF)
+        || option.matches(clang::driver::options::OPT_MT)
+        || option.matches(clang::driver::options::OPT_MQ)
+        || (
+             option.matches(clang::driver::options::OPT_INPUT)
+          && DependencyFile::getAbsolutePath(command.Directory, parsed[k]->getValue()) == mainFile
+        );
+      if (!isRemovedOption) {
+        continue;
+      }
+
+      // an option spans all arguments up to the next option (indices are shifted by the compiler)
+      size_t begin = parsed[k]->getIndex() + 1;
+      size_t end = k + 1 < parsed.size() ? parsed[k + 1]->getIndex() + 1 : arguments.size();
+      for (size_t i = begin; i < end; ++i) {
+        isRemoved[i] = true;
+      }
+    }
+
+    std::vector<std::string> flags;
+    for (size_t i = 0; i < arguments.size(); ++i) {
+      if (!isRemoved[i]) {
+        flags.push_back(arguments[i]);
+      }
+    }
+    return flags;
+  }
+
+  /** Computes a key that is shared by all compile commands with the same flags and working directory. */
+  static std::string getFlagsKey(clang::tooling::CompileCommand const &command) {
+    llvm::MD5 hasher;
+    hasher.update(command.Directory);
+    for (auto const &flag : getFlags(command)) {
+      hasher.update(llvm::StringRef("\0", 1));
+      hasher.update(flag);
+    }
+    llvm::MD5::MD5Result result;
+    hasher.final(result);
+    return result.digest().str().str();
+  }
+
+  /**
+   * Returns the #include <...> directives at the start of the source file of a given compile command.
+   * Blank lines and comments are skipped; the scan stops at the first line that is anything else.
+   */
+  static std::vector<std::string> findLeadingSystemIncludes(clang::tooling::CompileCommand const &command) {
+    std::vector<std::string> includes;
+    auto buffer = llvm::MemoryBuffer::getFile(CompileCommandDeduplicator::getSourceFilePath(command));
+    if (!buffer) {
+      return includes;
+    }
+
+    llvm::SmallVector<llvm::StringRef, 128> lines;
+    (*buffer)->getBuffer().split(lines, '\n');
+    bool inBlockComment = false;
+    for (auto line : lines) {
+      line = line.trim();
+      if (inBlockComment) {
+        inBlockComment = line.find("*/") == llvm::StringRef::npos;
+        continue;
+      }
+      if (line.empty() || line.startswith("//")) {
+        continue;
+      }
+      if (line.startswith("/*")) {
+        inBlockComment = line.find("*/") == llvm::StringRef::npos;
+        continue;
+      }
+      if (!line.startswith("#")) {
+        break;
+      }
+
+      auto directive = line.drop_front().ltrim();
+      if (!directive.consume_front("include")) {
+        break;
+      }
+      directive = directive.ltrim();
+      if (!directive.startswith("<") || directive.find('>') == llvm::StringRef::npos) {
+        break;
+      }
+      includes.push_back(directive.take_until([](char c) { return c == '>'; }).str() + ">");
+    }
+    return includes;
+  }
+
+  std::string getPath(std::string const &key, char const *extension) const {
+    llvm::SmallString<256> path(directory);
+    llvm::sys::path::append(path, key + "." + extension);
+    return path.str().str();
+  }
+
+  /** Builds the preamble for a group of compile commands, or reuses it if it is up to date. */
+  llvm::Optional<std::string> buildPreamble(
+      clang::tooling::CompileCommand const &representative,
+      std::string const &flagsKey,
+      std::vector<std::string> const &includes
+  ) const {
+    llvm::MD5 hasher;
+    hasher.update(clang::getClangFullVersion());
+    hasher.update(llvm::StringRef("\0", 1));
+    hasher.update(flagsKey);
+    for (auto const &include : includes) {
+      hasher.update(llvm::StringRef("\0", 1));
+      hasher.update(include);
+    }
+    llvm::MD5::MD5Result result;
+    hasher.final(result);
+    auto key = result.digest().str().str();
+
+    auto headerPath = getPath(key, "h");
+    auto preamblePath = getPath(key, "pch");
+    auto dependenciesPath = getPath(key, "deps");
+    if (llvm::sys::fs::exists(preamblePath) && DependencyFile::isUpToDate(dependenciesPath)) {
+      llvm::outs() << "reusing shared preamble: " << preamblePath << "\n";
+      return preamblePath;
+    }
+
+    {
+      std::error_code error;
+      llvm::raw_fd_ostream os(headerPath, error);
+      if (error) {
+        llvm::errs() << "WARNING: failed to write shared preamble header: " << headerPath << "\n";
+        return llvm::None;
+      }
+      for (auto const &include : includes) {
+        os << "#include " << include << "\n";
+      }
+    }
+
+    // the preamble is written to a temporary file first, so that a partially written
+    // preamble is never used by another run
+    llvm::SmallString<256> temporaryPath;
+    if (llvm::sys::fs::createUniqueFile(preamblePath + "-%%%%%%%%", temporaryPath)) {
+      return llvm::None;
+    }
+
+    auto command = representative;
+    command.Filename = headerPath;
+    command.CommandLine = getFlags(representative);
+    command.CommandLine.insert(command.CommandLine.end(), {
+      "-x", "c++-header", headerPath, "-o", temporaryPath.str().str()
+    });
+
+    llvm::outs() << "building shared preamble for " << includes.size() << " includes: " << preamblePath << "\n";
+    SingleCommandCompilationDatabase database(command);
+    clang::IgnoringDiagConsumer diagConsumer;
+    clang::tooling::ClangTool tool(
+      database,
+      {headerPath},
+      std::make_shared<clang::PCHContainerOperations>(),
+      llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem>(llvm::vfs::createPhysicalFileSystem().release())
+    );
+    tool.setDiagnosticConsumer(&diagConsumer);
+    // the default adjusters would turn the command into a syntax-only command without an output
+    tool.clearArgumentsAdjusters();
+
+    auto collector = std::make_shared<PreambleDependencyCollector>();
+    PreambleBuilderAction action(collector);
+    if (tool.run(&action) != 0) {
+      llvm::errs() << "WARNING: failed to build shared preamble: " << preamblePath << "\n";
+      llvm::sys::fs::remove(temporaryPath);
+      return llvm::None;
+    }
+
+    std::vector<std::string> dependencies = {headerPath};
+    for (auto const &dependency : collector->getDependencies()) {
+      dependencies.push_back(DependencyFile::getAbsolutePath(representative.Directory, dependency));
+    }
+    if (llvm::sys::fs::rename(temporaryPath, preamblePath)
+     || !DependencyFile::write(dependenciesPath, dependencies)) {
+      llvm::errs() << "WARNING: failed to write shared preamble: " << preamblePath << "\n";
+      llvm::sys::fs::remove(temporaryPath);
+      return llvm::None;
+    }
+    return preamblePath;
+  }
+};
+
+} // rosdiscover
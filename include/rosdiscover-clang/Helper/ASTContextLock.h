@@ -0,0 +1,27 @@
+#pragma once
+
+#include <mutex>
+
+namespace rosdiscover {
+
+/**
+ * Serializes the operations of the symbolizer that may update state cached by an ASTContext, or
+ * allocate in its allocator, such as constant evaluation and CFG construction (which synthesizes
+ * statements). Anything else that reads that state, such as Stmt::getID, which searches the
+ * allocator's slabs, must hold this lock as well. Other than that, function bodies are only read,
+ * which allows several functions to be symbolized concurrently.
+ */
+class ASTContextLock {
+public:
+  ASTContextLock() : lock(getMutex()) {}
+
+private:
+  std::lock_guard<std::recursive_mutex> lock;
+
+  static std::recursive_mutex & getMutex() {
+    static std::recursive_mutex mutex;
+    return mutex;
+  }
+};
+
+} // rosdiscover
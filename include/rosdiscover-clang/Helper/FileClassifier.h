@@ -0,0 +1,147 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <clang/Basic/SourceLocation.h>
+#include <clang/Basic/SourceManager.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringRef.h>
+
+namespace rosdiscover {
+
+/** A set of path prefixes that can be matched against a path in time linear in the length of that path. */
+class PathPrefixTrie {
+public:
+  PathPrefixTrie() : root(std::make_unique<Node>()) {}
+
+  void insert(llvm::StringRef prefix) {
+    auto *node = root.get();
+    for (char c : prefix) {
+      auto &child = node->children[c];
+      if (!child) {
+        child = std::make_unique<Node>();
+      }
+      node = child.get();
+    }
+    node->isPrefix = true;
+  }
+
+  /** Determines whether any prefix in this trie is a prefix of a given path. */
+  bool matchesPrefixOf(llvm::StringRef path) const {
+    auto const *node = root.get();
+    if (node->isPrefix) {
+      return true;
+    }
+    for (char c : path) {
+      auto it = node->children.find(c);
+      if (it == node->children.end()) {
+        return false;
+      }
+      node = it->second.get();
+      if (node->isPrefix) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  struct Node {
+    bool isPrefix = false;
+    std::map<char, std::unique_ptr<Node>> children;
+  };
+
+  std::unique_ptr<Node> root;
+};
+
+/** Describes whether the contents of a file should be analyzed. */
+enum class FileKind {
+  /** The file implements the ROS language bindings; calls within it aren't API calls of the program. */
+  RosInternal,
+  /** The file belongs to the program that is being analyzed. */
+  Allowed,
+  /** The file lies outside of the paths that the analysis is restricted to. */
+  Ignored
+};
+
+/**
+ * Classifies source files by whether the API calls within them should be analyzed.
+ * Each FileID is classified only once, and the paths that the analysis is restricted to are
+ * kept in a prefix trie. Classifications are specific to a source manager; they are discarded
+ * whenever a location from a different source manager is classified. A classifier isn't thread
+ * safe, but copies of it may be used concurrently.
+ */
+class FileClassifier {
+public:
+  FileClassifier(std::vector<std::string> const &restrictAnalysisToPaths = {})
+    : isRestricted(!restrictAnalysisToPaths.empty()),
+      allowedPaths(buildTrie(restrictAnalysisToPaths)),
+      sourceManager(nullptr),
+      fileKinds()
+  {}
+
+  /** Classifies the file that a given location (after macro expansion) belongs to. */
+  FileKind classify(clang::SourceManager const &sourceManager, clang::SourceLocation location) {
+    if (location.isInvalid()) {
+      return FileKind::Allowed;
+    }
+    if (this->sourceManager != &sourceManager) {
+      this->sourceManager = &sourceManager;
+      fileKinds.clear();
+    }
+
+    auto fileID = sourceManager.getFileID(sourceManager.getExpansionLoc(location));
+    auto it = fileKinds.find(fileID.getHashValue());
+    if (it != fileKinds.end()) {
+      return it->second;
+    }
+
+    auto kind = FileKind::Allowed;
+    if (auto const *file = sourceManager.getFileEntryForID(fileID)) {
+      kind = classify(file->getName());
+    }
+    fileKinds[fileID.getHashValue()] = kind;
+    return kind;
+  }
+
+  /** Classifies a file by its name. */
+  FileKind classify(llvm::StringRef filename) const {
+    if (
+         filename.endswith("/include/ros/node_handle.h")
+      || filename.endswith("/include/ros/param.h")
+      || filename.endswith("/include/ros/service.h")
+    ) {
+      return FileKind::RosInternal;
+    }
+    if (!isAllowedPath(filename)) {
+      return FileKind::Ignored;
+    }
+    return FileKind::Allowed;
+  }
+
+  /** Determines whether a file lies under the paths that the analysis is restricted to, if any. */
+  bool isAllowedPath(llvm::StringRef filename) const {
+    return !isRestricted || allowedPaths->matchesPrefixOf(filename);
+  }
+
+private:
+  bool isRestricted;
+  // the trie is never modified after construction, so it is shared between copies of a classifier
+  std::shared_ptr<PathPrefixTrie const> allowedPaths;
+  clang::SourceManager const *sourceManager;
+  // maps the raw encoding of each FileID that has been seen to its kind
+  llvm::DenseMap<unsigned, FileKind> fileKinds;
+
+  static std::shared_ptr<PathPrefixTrie const> buildTrie(std::vector<std::string> const &paths) {
+    auto trie = std::make_shared<PathPrefixTrie>();
+    for (auto const &path : paths) {
+      trie->insert(path);
+    }
+    return trie;
+  }
+};
+
+} // rosdiscover
@@ -2,6 +2,8 @@
 
 #include <string>
 
+#include "Log.h"
+
 namespace rosdiscover {
 
 std::string typeNameToFormatName(std::string typeName) {
@@ -12,7 +14,7 @@ std::string typeNameToFormatName(std::string typeName) {
 
   auto separatorPos = typeName.find("::");
   if (separatorPos == std::string::npos) {
-    llvm::outs() << "WARNING: unable to find :: separator in C++ type name for ROS format\n";
+    Log::outs() << "WARNING: unable to find :: separator in C++ type name for ROS format\n";
     return typeName;
   }
 
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+
+#include <llvm/Support/raw_ostream.h>
+
+namespace rosdiscover {
+
+/**
+ * The output streams used by the analysis of function bodies, which may run on several threads.
+ * By default, these are llvm::outs() and llvm::errs(). While a Log::Buffer exists on a thread,
+ * everything that the thread writes is collected in that buffer instead, and is written to the
+ * underlying streams in one piece once the buffer is destroyed. The output of concurrent tasks
+ * is therefore never interleaved.
+ */
+class Log {
+public:
+  static llvm::raw_ostream & outs() {
+    auto *buffer = getThreadBuffer();
+    return buffer == nullptr ? llvm::outs() : buffer->out;
+  }
+
+  static llvm::raw_ostream & errs() {
+    auto *buffer = getThreadBuffer();
+    return buffer == nullptr ? llvm::errs() : buffer->err;
+  }
+
+  /** Buffers all output of the current thread for as long as it exists. */
+  class Buffer {
+  public:
+    Buffer() : outText(), errText(), out(outText), err(errText), previous(getThreadBuffer()) {
+      getThreadBuffer() = this;
+    }
+
+    ~Buffer() {
+      getThreadBuffer() = previous;
+      if (previous != nullptr) {
+        previous->out << out.str();
+        previous->err << err.str();
+        return;
+      }
+      std::lock_guard<std::mutex> lock(getMutex());
+      llvm::outs() << out.str();
+      llvm::outs().flush();
+      llvm::errs() << err.str();
+    }
+
+    Buffer(Buffer const &) = delete;
+    Buffer & operator=(Buffer const &) = delete;
+
+  private:
+    friend class Log;
+
+    std::string outText;
+    std::string errText;
+    llvm::raw_string_ostream out;
+    llvm::raw_string_ostream err;
+    Buffer *previous;
+  };
+
+private:
+  static Buffer *& getThreadBuffer() {
+    static thread_local Buffer *buffer = nullptr;
+    return buffer;
+  }
+
+  static std::mutex & getMutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+};
+
+} // rosdiscover
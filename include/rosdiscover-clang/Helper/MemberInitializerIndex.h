@@ -0,0 +1,91 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <clang/AST/Decl.h>
+#include <clang/AST/DeclCXX.h>
+#include <clang/AST/ExprCXX.h>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/DenseMap.h>
+
+#include "Log.h"
+
+namespace rosdiscover {
+
+/**
+ * Maps the fields of CXX records to the expressions that initialize them: the in-class default
+ * member initializer, followed by the initializers in the initializer lists of all constructors
+ * that aren't copy or move constructors, in declaration order. Each record is indexed once, when
+ * one of its fields is first looked up. Lookups may happen concurrently.
+ */
+class MemberInitializerIndex {
+public:
+  MemberInitializerIndex() : mutex(), records() {}
+
+  /** Returns the expressions that initialize a given field. */
+  llvm::ArrayRef<clang::Expr *> find(clang::FieldDecl const *field) {
+    auto const *recordDecl = clang::dyn_cast<clang::CXXRecordDecl>(field->getParent());
+    if (recordDecl == nullptr) {
+      return {};
+    }
+
+    auto const &initializers = getRecordIndex(recordDecl);
+    auto it = initializers.find(field);
+    if (it == initializers.end()) {
+      return {};
+    }
+    return it->second;
+  }
+
+private:
+  using RecordIndex = llvm::DenseMap<clang::FieldDecl const *, std::vector<clang::Expr *>>;
+
+  std::mutex mutex;
+  llvm::DenseMap<clang::CXXRecordDecl const *, std::unique_ptr<RecordIndex>> records;
+
+  RecordIndex const & getRecordIndex(clang::CXXRecordDecl const *recordDecl) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &index = records[recordDecl];
+    if (index == nullptr) {
+      index = build(recordDecl);
+    }
+    return *index;
+  }
+
+  static std::unique_ptr<RecordIndex> build(clang::CXXRecordDecl const *recordDecl) {
+    auto index = std::make_unique<RecordIndex>();
+    for (auto const *field : recordDecl->fields()) {
+      if (field->hasInClassInitializer() && field->getInClassInitializer() != nullptr) {
+        (*index)[field].push_back(field->getInClassInitializer());
+      }
+    }
+
+    for (auto const *constructorDecl : recordDecl->ctors()) {
+      if (constructorDecl->isCopyOrMoveConstructor())
+        continue;
+
+      auto const *constructorDef = clang::dyn_cast_or_null<clang::CXXConstructorDecl>(
+        constructorDecl->getDefinition()
+      );
+      if (constructorDef == nullptr) {
+        Log::errs() << "WARNING: unable to retrieve definition for constructor: ";
+        constructorDecl->dump(Log::errs());
+        Log::errs() << "\n";
+        continue;
+      }
+
+      for (auto const *initDecl : constructorDef->inits()) {
+        auto const *field = initDecl->getMember();
+        // fields that aren't initialized explicitly refer to their in-class initializer
+        if (field == nullptr || clang::isa<clang::CXXDefaultInitExpr>(initDecl->getInit()))
+          continue;
+        (*index)[field].push_back(initDecl->getInit());
+      }
+    }
+    return index;
+  }
+};
+
+} // rosdiscover
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include <sys/resource.h>
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace rosdiscover {
+
+/** Reads the resident set size of this process. All sizes are given in bytes. */
+class MemoryUsage {
+public:
+  /** Returns the current resident set size, or zero if it can't be determined. */
+  static uint64_t getCurrentRSS() {
+    return readStatusField("VmRSS:");
+  }
+
+  /** Returns the peak resident set size since the process started or since the peak was last reset. */
+  static uint64_t getPeakRSS() {
+    auto peak = readStatusField("VmHWM:");
+    if (peak == 0) {
+      struct rusage usage;
+      if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        peak = static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+      }
+    }
+    return peak;
+  }
+
+  /** Resets the peak resident set size to the current one. Returns false if that isn't supported. */
+  static bool resetPeakRSS() {
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+    clearRefs.flush();
+    return static_cast<bool>(clearRefs);
+  }
+
+  static uint64_t toMiB(uint64_t bytes) {
+    return bytes / (1024 * 1024);
+  }
+
+private:
+  /** Reads a field, given in kB, from /proc/self/status. */
+  static uint64_t readStatusField(llvm::StringRef field) {
+    auto buffer = llvm::MemoryBuffer::getFileAsStream("/proc/self/status");
+    if (!buffer) {
+      return 0;
+    }
+
+    llvm::StringRef contents = (*buffer)->getBuffer();
+    auto position = contents.find(field);
+    if (position == llvm::StringRef::npos) {
+      return 0;
+    }
+
+    uint64_t kilobytes = 0;
+    auto value = contents.drop_front(position + field.size()).ltrim();
+    value = value.take_while([](char c) { return c >= '0' && c <= '9'; });
+    if (value.getAsInteger(10, kilobytes)) {
+      return 0;
+    }
+    return kilobytes * 1024;
+  }
+};
+
+/** Reports the peak resident set size of each phase of the analysis. */
+class PhaseMemoryReporter {
+public:
+  PhaseMemoryReporter(std::string const &phase)
+    : phase(phase), isPeakReset(MemoryUsage::resetPeakRSS())
+  {}
+
+  ~PhaseMemoryReporter() {
+    llvm::outs()
+      << "memory usage [" << phase << "]: peak RSS "
+      << MemoryUsage::toMiB(MemoryUsage::getPeakRSS()) << " MiB"
+      << (isPeakReset ? "" : " (since start)")
+      << ", current RSS " << MemoryUsage::toMiB(MemoryUsage::getCurrentRSS()) << " MiB\n";
+  }
+
+private:
+  std::string phase;
+  bool isPeakReset;
+};
+
+} // rosdiscover
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include <clang/AST/ASTContext.h>
+#include <clang/AST/Decl.h>
+#include <clang/AST/Expr.h>
+#include <clang/AST/ExprCXX.h>
+#include <clang/AST/LexicallyOrderedRecursiveASTVisitor.h>
+#include <clang/AST/Stmt.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallVector.h>
+
+#include "utils.h"
+
+namespace rosdiscover {
+
+/**
+ * Finds the definitions of local variables that reach a given location within a function.
+ *
+ * The first query for a location within a function indexes that function (along with any
+ * functions that are nested within it) in a single, lexically ordered traversal: each statement
+ * is numbered in traversal order, and the definitions of each variable are recorded along with
+ * the number of the last statement within the statement that defines them. A definition reaches
+ * a location if it precedes that location within the innermost enclosing function. All further
+ * queries for the same function are answered from the index.
+ *
+ * Variables are defined by their initializers, and by (compound) assignments to them, including
+ * calls to overloaded assignment operators. The value of a simple assignment is its right-hand
+ * side; the value of a compound assignment is the assignment expression itself.
+ *
+ * NOTE: this is intra-procedural and path-insensitive for now: every definition that lexically
+ *  precedes a location reaches it, even if it is overwritten on every path to that location.
+ */
+class ReachingDefinitions {
+public:
+  ReachingDefinitions(clang::ASTContext &astContext)
+    : astContext(astContext),
+      statements(),
+      functionRanges(),
+      definitions(),
+      numStatements(0)
+  {}
+
+  /** Returns all definitions of a given variable that reach a given location, in lexical order. */
+  std::vector<clang::Expr *> findAll(clang::VarDecl const *decl, clang::Expr const *location) {
+    std::vector<clang::Expr *> result;
+    auto range = findRange(location);
+    auto it = definitions.find(decl);
+    if (range.first >= range.second || it == definitions.end()) {
+      return result;
+    }
+    for (auto const &definition : it->second) {
+      if (definition.first >= range.first && definition.first < range.second) {
+        result.push_back(definition.second);
+      }
+    }
+    return result;
+  }
+
+  /** Returns the last definition of a given variable that reaches a given location, or nullptr if there is none. */
+  clang::Expr * find(clang::VarDecl const *decl, clang::Expr const *location) {
+    auto all = findAll(decl, location);
+    return all.empty() ? nullptr : all.back();
+  }
+
+private:
+  using Range = std::pair<unsigned, unsigned>;
+
+  clang::ASTContext &astContext;
+  // the number of each indexed statement, and the innermost function that contains it
+  llvm::DenseMap<clang::Stmt const *, std::pair<unsigned, clang::FunctionDecl const *>> statements;
+  // the numbers of the statements within each indexed function
+  llvm::DenseMap<clang::FunctionDecl const *, Range> functionRanges;
+  // the definitions of each variable, in lexical order, along with the number that they take effect after
+  llvm::DenseMap<clang::VarDecl const *, llvm::SmallVector<std::pair<unsigned, clang::Expr *>, 1>> definitions;
+  unsigned numStatements;
+
+  class IndexBuilder : public clang::LexicallyOrderedRecursiveASTVisitor<IndexBuilder> {
+  public:
+    IndexBuilder(ReachingDefinitions &index)
+      : LexicallyOrderedRecursiveASTVisitor(index.astContext.getSourceManager()),
+        index(index),
+        currentFunction(nullptr),
+        pendingDefinitions()
+    {}
+
+    bool TraverseDecl(clang::Decl *decl) {
+      auto const *function = clang::dyn_cast_or_null<clang::FunctionDecl>(decl);
+      if (function == nullptr) {
+        return clang::LexicallyOrderedRecursiveASTVisitor<IndexBuilder>::TraverseDecl(decl);
+      }
+
+      auto const *enclosingFunction = currentFunction;
+      currentFunction = function;
+      auto begin = index.numStatements;
+      bool result = clang::LexicallyOrderedRecursiveASTVisitor<IndexBuilder>::TraverseDecl(decl);
+      index.functionRanges.try_emplace(function, begin, index.numStatements);
+      currentFunction = enclosingFunction;
+      return result;
+    }
+
+    bool VisitStmt(clang::Stmt *stmt) {
+      index.statements.try_emplace(stmt, index.numStatements++, currentFunction);
+      return true;
+    }
+
+    bool VisitDeclStmt(clang::DeclStmt *stmt) {
+      for (auto *decl : stmt->decls()) {
+        auto const *varDecl = clang::dyn_cast<clang::VarDecl>(decl);
+        if (varDecl != nullptr && varDecl->hasInit()) {
+          pendingDefinitions[stmt].emplace_back(varDecl, const_cast<clang::Expr*>(varDecl->getInit()));
+        }
+      }
+      return true;
+    }
+
+    bool VisitBinaryOperator(clang::BinaryOperator *op) {
+      if (!op->isAssignmentOp()) {
+        return true;
+      }
+      if (auto const *varDecl = getAssignedVar(op->getLHS())) {
+        auto *value = op->getOpcode() == clang::BO_Assign ? op->getRHS() : op;
+        pendingDefinitions[op].emplace_back(varDecl, value);
+      }
+      return true;
+    }
+
+    bool VisitCXXOperatorCallExpr(clang::CXXOperatorCallExpr *call) {
+      if (!call->isAssignmentOp() || call->getNumArgs() != 2) {
+        return true;
+      }
+      if (auto const *varDecl = getAssignedVar(call->getArg(0))) {
+        auto *value = call->getOperator() == clang::OO_Equal ? call->getArg(1) : call;
+        pendingDefinitions[call].emplace_back(varDecl, value);
+      }
+      return true;
+    }
+
+    // called once all children of a statement have been numbered
+    bool dataTraverseStmtPost(clang::Stmt *stmt) {
+      auto it = pendingDefinitions.find(stmt);
+      if (it == pendingDefinitions.end()) {
+        return true;
+      }
+      // a definition doesn't reach the statements within the statement that makes it (e.g., x = x + 1)
+      auto number = index.numStatements - 1;
+      for (auto const &definition : it->second) {
+        index.definitions[definition.first].emplace_back(number, definition.second);
+      }
+      pendingDefinitions.erase(it);
+      return true;
+    }
+
+  private:
+    ReachingDefinitions &index;
+    clang::FunctionDecl const *currentFunction;
+    // the definitions made by statements whose children haven't been numbered yet
+    llvm::DenseMap<clang::Stmt const *, llvm::SmallVector<std::pair<clang::VarDecl const *, clang::Expr *>, 1>> pendingDefinitions;
+
+    static clang::VarDecl const * getAssignedVar(clang::Expr const *lhs) {
+      auto const *declRefExpr = clang::dyn_cast<clang::DeclRefExpr>(lhs->IgnoreParenImpCasts());
+      return declRefExpr == nullptr ? nullptr : clang::dyn_cast<clang::VarDecl>(declRefExpr->getDecl());
+    }
+  };
+
+  /**
+   * Returns the numbers of the statements that precede a given location within its innermost
+   * enclosing function, indexing that function if necessary.
+   */
+  Range findRange(clang::Expr const *location) {
+    auto it = statements.find(location);
+    if (it != statements.end()) {
+      auto const &function = functionRanges[it->second.second];
+      return {function.first, it->second.first};
+    }
+
+    // the location hasn't been indexed yet; find and index the function to which it belongs
+    auto const *function = getParentFunctionDecl(astContext, location);
+    if (function == nullptr) {
+      return {0, 0};
+    }
+    if (!functionRanges.count(function)) {
+      IndexBuilder(*this).TraverseDecl(const_cast<clang::FunctionDecl*>(function));
+    }
+
+    it = statements.find(location);
+    if (it != statements.end()) {
+      auto const &range = functionRanges[it->second.second];
+      return {range.first, it->second.first};
+    }
+    // the location isn't visited by the traversal, so every definition within the function reaches it
+    return functionRanges[function];
+  }
+};
+
+} // rosdiscover
@@ -6,6 +6,8 @@
 #include <clang/AST/LexicallyOrderedRecursiveASTVisitor.h>
 #include <clang/AST/Stmt.h>
 
+#include "Log.h"
+
 namespace rosdiscover {
 
 class StmtOrderingVisitor
@@ -42,13 +44,13 @@ public:
 
     // ensure that we found every statement
     if (!visitor.statementsToFind.empty()) {
-      llvm::errs() << "FATAL ERROR: failed to order all statements\n";
+      Log::errs() << "FATAL ERROR: failed to order all statements\n";
       for (auto *statement : visitor.statementsToFind) {
-        llvm::errs() << "-> failed to find statement: ";
-        statement->dumpColor();
-        llvm::errs() << "\n";
-        statement->getBeginLoc().dump(astContext.getSourceManager());
-        llvm::errs() << "\n";
+        Log::errs() << "-> failed to find statement: ";
+        statement->dump(Log::errs(), astContext);
+        Log::errs() << "\n";
+        statement->getBeginLoc().print(Log::errs(), astContext.getSourceManager());
+        Log::errs() << "\n";
       }
       abort();
     }
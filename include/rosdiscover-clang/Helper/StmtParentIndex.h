@@ -0,0 +1,161 @@
+#pragma once
+
+#include <mutex>
+#include <utility>
+
+#include <clang/AST/ASTContext.h>
+#include <clang/AST/Decl.h>
+#include <clang/AST/RecursiveASTVisitor.h>
+#include <clang/AST/Stmt.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallVector.h>
+
+#include "../ApiCall/Calls/Util.h"
+#include "utils.h"
+
+namespace rosdiscover {
+
+/**
+ * Records, for every statement of a function, the innermost function to which it belongs and its
+ * closest enclosing control-flow statement (i.e., an IfStmt or a WhileStmt) within that function.
+ * Statements are also numbered in preorder, along with the highest number within their subtree,
+ * so whether one statement contains another is decided by comparing their numbers.
+ *
+ * Functions are indexed on demand: the first query for a statement that isn't indexed yet finds
+ * its function by walking up the parent map once, and then indexes the entire body of that
+ * function (including any functions that are nested within it) in a single traversal. All other
+ * queries for statements of that function are hash lookups. Queries may happen concurrently.
+ */
+class StmtParentIndex {
+public:
+  StmtParentIndex(clang::ASTContext &astContext) : astContext(astContext), mutex(), parents(), numStmts(0) {}
+
+  /** Returns the function to which a given statement belongs, or nullptr if there is none. */
+  clang::FunctionDecl const * getFunction(clang::Stmt const *stmt) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto const *entry = find(stmt);
+    return entry == nullptr ? nullptr : entry->function;
+  }
+
+  /**
+   * Returns the closest IfStmt or WhileStmt that encloses a given statement within its function,
+   * or nullptr if there is none.
+   */
+  clang::Stmt const * getControlFlowParent(clang::Stmt const *stmt) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto const *entry = find(stmt);
+    return entry == nullptr ? nullptr : entry->controlFlowParent;
+  }
+
+  /** Determines whether a given statement is a (transitive) child of another. */
+  bool contains(clang::Stmt const *parent, clang::Stmt const *child) {
+    if (parent == nullptr || child == nullptr) {
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    // finding the child may index another function, so the parent's entry is copied first
+    auto const *entry = find(parent);
+    if (entry == nullptr || !entry->isNumbered()) {
+      return stmtContainsStmt(parent, child);
+    }
+    auto parentEntry = *entry;
+    auto const *childEntry = find(child);
+    if (childEntry == nullptr || !childEntry->isNumbered()) {
+      return stmtContainsStmt(parent, child);
+    }
+    return parentEntry.first < childEntry->first && childEntry->first <= parentEntry.last;
+  }
+
+private:
+  struct Entry {
+    clang::FunctionDecl const *function;
+    clang::Stmt const *controlFlowParent;
+    // the preorder numbers of the statement and of the last statement within its subtree
+    unsigned first;
+    unsigned last;
+
+    bool isNumbered() const {
+      return first <= last;
+    }
+  };
+
+  clang::ASTContext &astContext;
+  std::mutex mutex;
+  llvm::DenseMap<clang::Stmt const *, Entry> parents;
+  // numbers are unique across all indexed functions
+  unsigned numStmts;
+
+  class IndexBuilder : public clang::RecursiveASTVisitor<IndexBuilder> {
+  public:
+    IndexBuilder(StmtParentIndex &index) : index(index), currentFunction(nullptr), controlFlowStmts() {}
+
+    bool shouldVisitImplicitCode() const { return true; }
+
+    bool TraverseDecl(clang::Decl *decl) {
+      auto const *function = clang::dyn_cast_or_null<clang::FunctionDecl>(decl);
+      if (function == nullptr) {
+        return clang::RecursiveASTVisitor<IndexBuilder>::TraverseDecl(decl);
+      }
+
+      // control flow never crosses into a nested function
+      auto const *enclosingFunction = currentFunction;
+      auto enclosingControlFlowStmts = std::move(controlFlowStmts);
+      currentFunction = function;
+      controlFlowStmts.clear();
+      bool result = clang::RecursiveASTVisitor<IndexBuilder>::TraverseDecl(decl);
+      currentFunction = enclosingFunction;
+      controlFlowStmts = std::move(enclosingControlFlowStmts);
+      return result;
+    }
+
+    bool TraverseStmt(clang::Stmt *stmt, DataRecursionQueue *queue = nullptr) {
+      if (stmt == nullptr) {
+        return true;
+      }
+
+      auto const *controlFlowParent = controlFlowStmts.empty() ? nullptr : controlFlowStmts.back();
+      auto number = index.numStmts++;
+      auto inserted = index.parents.try_emplace(stmt, Entry{currentFunction, controlFlowParent, number, number}).second;
+
+      bool isControlFlowStmt = clang::isa<clang::IfStmt>(stmt) || clang::isa<clang::WhileStmt>(stmt);
+      if (isControlFlowStmt) {
+        controlFlowStmts.push_back(stmt);
+      }
+      // the data recursion queue is not used, so that the stack reflects the ancestors of each statement
+      bool result = clang::RecursiveASTVisitor<IndexBuilder>::TraverseStmt(stmt, nullptr);
+      if (isControlFlowStmt) {
+        controlFlowStmts.pop_back();
+      }
+      if (inserted) {
+        index.parents[stmt].last = index.numStmts - 1;
+      }
+      return result;
+    }
+
+  private:
+    StmtParentIndex &index;
+    clang::FunctionDecl const *currentFunction;
+    llvm::SmallVector<clang::Stmt const *, 8> controlFlowStmts;
+  };
+
+  Entry const * find(clang::Stmt const *stmt) {
+    auto it = parents.find(stmt);
+    if (it == parents.end()) {
+      // the statement hasn't been indexed yet; find and index the function to which it belongs
+      auto const *function = getParentFunctionDecl(astContext, stmt);
+      if (function == nullptr) {
+        return nullptr;
+      }
+      IndexBuilder(*this).TraverseDecl(const_cast<clang::FunctionDecl*>(function));
+      it = parents.find(stmt);
+      if (it == parents.end()) {
+        // the statement isn't visited by the traversal, so it isn't numbered either
+        it = parents.try_emplace(stmt, Entry{function, nullptr, 1, 0}).first;
+      }
+    }
+    return &it->second;
+  }
+};
+
+} // rosdiscover
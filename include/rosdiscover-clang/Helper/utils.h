@@ -1,5 +1,6 @@
 #pragma once
 
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -7,7 +8,8 @@
 #include <clang/AST/ASTTypeTraits.h>
 #include <clang/AST/Decl.h>
 #include <clang/AST/Stmt.h>
-#include <clang/Analysis/CallGraph.h>
+#include <clang/Index/USRGeneration.h>
+#include <llvm/ADT/SmallString.h>
 
 namespace rosdiscover {
 
@@ -42,32 +44,14 @@ clang::FunctionDecl const * getParentFunctionDecl(clang::ASTContext &context, co
   return getParentFunctionDecl(context, clang::DynTypedNode::create(*stmt));
 }
 
-/** Uses a given call graph to produce a mapping from functions to their callers */
-std::unordered_map<clang::FunctionDecl const *, std::unordered_set<clang::FunctionDecl const *>> findCallers(
-  clang::CallGraph &callGraph
-) {
-  std::unordered_map<clang::FunctionDecl const *, std::unordered_set<clang::FunctionDecl const *>> functionToCallers;
-
-  for (auto const &callGraphEntry : callGraph) {
-    if (callGraphEntry.first == nullptr || !clang::isa<clang::FunctionDecl>(callGraphEntry.first)) {
-      continue;
-    }
-
-    clang::FunctionDecl const *caller = clang::dyn_cast<clang::FunctionDecl>(callGraphEntry.first)->getCanonicalDecl();
-    clang::CallGraphNode const &callerNode = *callGraphEntry.second.get();
-    for (clang::CallGraphNode::CallRecord const &callRecord : callerNode) {
-      auto const *callee = clang::dyn_cast<clang::FunctionDecl>(callRecord.Callee->getDecl())->getCanonicalDecl();
-
-      if (functionToCallers.find(callee) != functionToCallers.end()) {
-        functionToCallers[callee].insert(caller);
-      } else {
-        functionToCallers.emplace(callee, std::unordered_set<clang::FunctionDecl const *>());
-        functionToCallers[callee].insert(caller);
-      }
-    }
+/** Returns an identifier for a function that is stable across translation units (i.e., its USR). */
+std::string getFunctionId(clang::FunctionDecl const *function) {
+  llvm::SmallString<128> usr;
+  // generateUSRForDecl returns true on failure
+  if (clang::index::generateUSRForDecl(function, usr)) {
+    return function->getQualifiedNameAsString();
   }
-
-  return functionToCallers;
+  return usr.str().str();
 }
 
 } // rosdiscover
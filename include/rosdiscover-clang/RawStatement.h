@@ -2,6 +2,7 @@
 
 #include <clang/AST/Stmt.h>
 
+#include "Helper/Log.h"
 #include "ApiCall/RosApiCall.h"
 #include "Ast/Stmt/If.h"
 #include "Ast/Stmt/While.h"
@@ -199,7 +200,7 @@ public:
 
   clang::FunctionDecl const * getTargetFunction() const {
     if (callback == nullptr) {
-      llvm::outs() << "ERROR: No callback";
+      Log::outs() << "ERROR: No callback";
     }
     return callback->getTargetFunction();
   }
@@ -4,6 +4,7 @@
 
 #include <nlohmann/json.hpp>
 #include <llvm/Support/raw_ostream.h>
+#include "../Helper/Log.h"
 #include "../Ast/Stmt/SymbolicExpr.h"
 #include <fmt/core.h>
 
@@ -32,7 +33,7 @@ public:
   }
 
   static SymbolicValueType getSymbolicType(std::string const &typeName) {
-    llvm::outs() << "DEBUG: determining symbolic type for Clang type [" << typeName << "]\n";
+    Log::outs() << "DEBUG: determining symbolic type for Clang type [" << typeName << "]\n";
     if (typeName == "std::string"
      || typeName.find("const char") != std::string::npos
      || typeName == "std::string &"
@@ -223,4 +224,35 @@ private:
   std::unique_ptr<SymbolicString> name;
 };
 
+/** Refers to a node handle that has been resolved once and is shared by several API calls. */
+class SharedNodeHandle :
+  public virtual SymbolicNodeHandle
+{
+public:
+  SharedNodeHandle(std::shared_ptr<SymbolicNodeHandle const> nodeHandle)
+    : nodeHandle(std::move(nodeHandle)) {
+      assert(this->nodeHandle != nullptr);
+  }
+  ~SharedNodeHandle(){}
+
+  bool isUnknown() const override {
+    return nodeHandle->isUnknown();
+  }
+
+  void print(llvm::raw_ostream &os) const override {
+    nodeHandle->print(os);
+  }
+
+  std::string toString() const override {
+    return nodeHandle->toString();
+  }
+
+  nlohmann::json toJson() const override {
+    return nodeHandle->toJson();
+  }
+
+private:
+  std::shared_ptr<SymbolicNodeHandle const> nodeHandle;
+};
+
 } // rosdiscover
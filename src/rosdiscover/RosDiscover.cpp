@@ -33,18 +33,97 @@ static llvm::cl::list<std::string> restrictAnalysisToPaths(
   llvm::cl::value_desc("restrict-analysis-to-paths")
 );
 
+static llvm::cl::opt<unsigned> numJobs(
+  "j",
+  llvm::cl::desc("the number of translation units to parse in parallel (0 uses all available cores)."),
+  llvm::cl::value_desc("jobs"),
+  llvm::cl::init(1)
+);
+
+static llvm::cl::opt<DuplicateCommandPolicy> duplicateCommandPolicy(
+  "duplicate-commands",
+  llvm::cl::desc("the compile command that should be parsed for a source file that is built by multiple targets."),
+  llvm::cl::values(
+    clEnumValN(DuplicateCommandPolicy::KeepFirst, "first", "parse the first compile command for the file"),
+    clEnumValN(DuplicateCommandPolicy::KeepLast, "last", "parse the last compile command for the file")
+  ),
+  llvm::cl::init(DuplicateCommandPolicy::KeepFirst)
+);
+
+static llvm::cl::opt<bool> enableRosApiPrefilter(
+  "ros-prefilter",
+  llvm::cl::desc("skip translation units that never mention the ROS API, neither in their source file nor in their project headers (may miss calls made through project wrappers)."),
+  llvm::cl::init(false)
+);
+
+static llvm::cl::opt<std::string> astCacheDirectory(
+  "ast-cache-dir",
+  llvm::cl::desc("a directory in which parsed ASTs are cached and reused between runs (disabled by default)."),
+  llvm::cl::value_desc("directory"),
+  llvm::cl::init("")
+);
+
+static llvm::cl::opt<bool> useSharedPreambles(
+  "shared-preambles",
+  llvm::cl::desc("precompile the system includes that are shared by translation units with the same flags."),
+  llvm::cl::init(false)
+);
+
+static llvm::cl::opt<bool> linkSummaries(
+  "link-summaries",
+  llvm::cl::desc("analyze each translation unit separately and link the results instead of merging all ASTs."),
+  llvm::cl::init(false)
+);
+
+static llvm::cl::opt<unsigned> memoryLimit(
+  "max-memory",
+  llvm::cl::desc("a soft limit on resident memory in MiB that bounds how many ASTs are held at once; requires --link-summaries (0 disables the limit)."),
+  llvm::cl::value_desc("MiB"),
+  llvm::cl::init(0)
+);
+
+static llvm::cl::opt<unsigned> numMatchJobs(
+  "match-jobs",
+  llvm::cl::desc("the number of threads that search each AST for ROS API calls (0 uses all available cores)."),
+  llvm::cl::value_desc("jobs"),
+  llvm::cl::init(1)
+);
+
+static llvm::cl::opt<unsigned> numSymbolizeJobs(
+  "symbolize-jobs",
+  llvm::cl::desc("the number of threads that symbolize relevant functions in parallel (0 uses all available cores)."),
+  llvm::cl::value_desc("jobs"),
+  llvm::cl::init(1)
+);
+
 int main(int argc, const char **argv) {
   CommonOptionsParser optionsParser(argc, argv, MyToolCategory);
+  if (memoryLimit != 0 && !linkSummaries) {
+    llvm::errs() << "ERROR: --max-memory requires --link-summaries, since merged ASTs are all held at once\n";
+    return 1;
+  }
 
   auto sourcePaths = optionsParser.getSourcePathList();
   for (auto const &sourcePath : sourcePaths) {
     llvm::outs() << "DEBUG: using source path: " << sourcePath << "\n";
   }
 
+  SymbolizerOptions options;
+  options.numJobs = numJobs;
+  options.duplicateCommandPolicy = duplicateCommandPolicy;
+  options.useRosApiPrefilter = enableRosApiPrefilter;
+  options.astCacheDirectory = astCacheDirectory;
+  options.useSharedPreambles = useSharedPreambles;
+  options.linkSummaries = linkSummaries;
+  options.memoryLimitMiB = memoryLimit;
+  options.numMatchJobs = numMatchJobs;
+  options.numSymbolizeJobs = numSymbolizeJobs;
+
   auto program = ProgramSymbolizer::symbolize(
     optionsParser.getCompilations(),
     sourcePaths,
-    restrictAnalysisToPaths
+    restrictAnalysisToPaths,
+    options
   );
   auto json = program->toJson();
   std::cout << std::setw(2) << json;
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <rosdiscover-clang/BackwardSymbolizer/CallerIndex.h>
+
+#include "TestUtils.h"
+
+using namespace rosdiscover;
+using namespace clang::ast_matchers;
+
+namespace {
+
+char const *header = R"(
+  void libLeaf();
+  inline void libHelper() { libLeaf(); }
+)";
+
+char const *code = R"(
+  #include "/lib/include/lib.h"
+
+  void leaf() {}
+  void mid() { leaf(); }
+  void top() { mid(); libHelper(); }
+
+  struct Widget {
+    Widget() { leaf(); }
+  };
+  void build() {
+    Widget widget;
+    auto lambda = [] { leaf(); };
+    lambda();
+  }
+
+  template <typename T>
+  void generic(T) { leaf(); }
+  void instantiate() { generic(1); }
+)";
+
+bool hasEdge(CallerIndex const &index, clang::FunctionDecl const *callee, clang::FunctionDecl const *caller) {
+  auto const &edges = index.getEdges();
+  CompactCallGraph::Edge edge(callee->getCanonicalDecl(), caller->getCanonicalDecl());
+  return std::find(edges.begin(), edges.end(), edge) != edges.end();
+}
+
+bool hasFunction(CallerIndex const &index, clang::FunctionDecl const *function) {
+  auto const &functions = index.getFunctions();
+  return std::find(functions.begin(), functions.end(), function->getCanonicalDecl()) != functions.end();
+}
+
+clang::FunctionDecl const * findFunction(clang::ASTContext &context, std::string const &name) {
+  return test::findOnly<clang::FunctionDecl>(context, functionDecl(hasName(name), unless(isTemplateInstantiation())));
+}
+
+} // namespace
+
+int main() {
+  auto ast = test::buildAST(code, "/project/src/input.cc", {{"/lib/include/lib.h", header}});
+  ROSDISCOVER_CHECK(ast != nullptr);
+  if (ast == nullptr) {
+    return test::finish();
+  }
+  auto &context = ast->getASTContext();
+  auto const *libLeaf = findFunction(context, "libLeaf");
+  auto const *libHelper = findFunction(context, "libHelper");
+  auto const *leaf = findFunction(context, "leaf");
+  auto const *mid = findFunction(context, "mid");
+  auto const *top = findFunction(context, "top");
+  auto const *build = findFunction(context, "build");
+  auto const *instantiate = findFunction(context, "instantiate");
+  auto const *constructor = test::findOnly<clang::FunctionDecl>(
+    context, cxxConstructorDecl(ofClass(hasName("Widget")), isDefaultConstructor())
+  );
+  auto const *generic = test::findOnly<clang::FunctionDecl>(
+    context, functionDecl(hasName("generic"), isTemplateInstantiation())
+  );
+  bool found = libLeaf && libHelper && leaf && mid && top && build && instantiate && constructor && generic;
+  ROSDISCOVER_CHECK(found);
+  if (!found) {
+    return test::finish();
+  }
+
+  // only the project's own files are traversed
+  FileClassifier restricted({"/project/src"});
+  auto index = CallerIndex::build(context, restricted);
+  ROSDISCOVER_CHECK(hasEdge(*index, leaf, mid));
+  ROSDISCOVER_CHECK(hasEdge(*index, mid, top));
+  ROSDISCOVER_CHECK(hasEdge(*index, libHelper, top));
+  ROSDISCOVER_CHECK(hasEdge(*index, leaf, constructor));
+  ROSDISCOVER_CHECK(hasEdge(*index, constructor, build));
+  // calls within a lambda belong to the enclosing function
+  ROSDISCOVER_CHECK(hasEdge(*index, leaf, build));
+  ROSDISCOVER_CHECK(hasEdge(*index, generic, instantiate));
+  ROSDISCOVER_CHECK(hasEdge(*index, leaf, generic));
+  ROSDISCOVER_CHECK(!hasEdge(*index, libLeaf, libHelper));
+  ROSDISCOVER_CHECK(!hasEdge(*index, top, mid));
+
+  ROSDISCOVER_CHECK(hasFunction(*index, leaf));
+  ROSDISCOVER_CHECK(hasFunction(*index, constructor));
+  ROSDISCOVER_CHECK(hasFunction(*index, generic));
+  // called from a project file, but defined elsewhere
+  ROSDISCOVER_CHECK(hasFunction(*index, libHelper));
+  ROSDISCOVER_CHECK(!hasFunction(*index, libLeaf));
+
+  FileClassifier unrestricted;
+  auto fullIndex = CallerIndex::build(context, unrestricted);
+  ROSDISCOVER_CHECK(hasEdge(*fullIndex, libLeaf, libHelper));
+  ROSDISCOVER_CHECK(hasEdge(*fullIndex, leaf, mid));
+
+  FileClassifier elsewhere({"/other"});
+  auto emptyIndex = CallerIndex::build(context, elsewhere);
+  ROSDISCOVER_CHECK(emptyIndex->getEdges().empty());
+  ROSDISCOVER_CHECK(emptyIndex->getFunctions().empty());
+
+  return test::finish();
+}
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <vector>
+
+#include <rosdiscover-clang/BackwardSymbolizer/CompactCallGraph.h>
+
+#include "TestUtils.h"
+
+using namespace rosdiscover;
+using namespace clang::ast_matchers;
+
+namespace {
+
+char const *code = R"(
+  void a();
+  void b();
+  void c();
+  void d();
+  void e();
+  void unused();
+)";
+
+std::vector<unsigned> sorted(std::vector<unsigned> indices) {
+  std::sort(indices.begin(), indices.end());
+  return indices;
+}
+
+/** Returns the indices of the set bits of a given bit vector, in ascending order. */
+std::vector<unsigned> getSetBits(llvm::BitVector const &bits) {
+  std::vector<unsigned> indices;
+  for (auto index : bits.set_bits()) {
+    indices.push_back(index);
+  }
+  return indices;
+}
+
+std::vector<unsigned> getCallers(CompactCallGraph const &graph, clang::FunctionDecl const *function) {
+  auto callers = graph.getCallers(graph.getIndex(function));
+  return sorted(std::vector<unsigned>(callers.begin(), callers.end()));
+}
+
+} // namespace
+
+int main() {
+  auto ast = test::buildAST(code);
+  ROSDISCOVER_CHECK(ast != nullptr);
+  if (ast == nullptr) {
+    return test::finish();
+  }
+  auto &context = ast->getASTContext();
+  auto const *a = test::findOnly<clang::FunctionDecl>(context, functionDecl(hasName("a")));
+  auto const *b = test::findOnly<clang::FunctionDecl>(context, functionDecl(hasName("b")));
+  auto const *c = test::findOnly<clang::FunctionDecl>(context, functionDecl(hasName("c")));
+  auto const *d = test::findOnly<clang::FunctionDecl>(context, functionDecl(hasName("d")));
+  auto const *e = test::findOnly<clang::FunctionDecl>(context, functionDecl(hasName("e")));
+  auto const *unused = test::findOnly<clang::FunctionDecl>(context, functionDecl(hasName("unused")));
+  ROSDISCOVER_CHECK(a && b && c && d && e && unused);
+  if (!(a && b && c && d && e && unused)) {
+    return test::finish();
+  }
+
+  // (callee, caller): a <- b <- c, a <- d, and a cycle b <- c <- b; e is added as an extra edge
+  std::vector<CompactCallGraph::Edge> calls = {{a, b}, {b, c}, {a, d}, {c, b}, {a, b}};
+  CompactCallGraph graph(calls, {{d, e}});
+
+  ROSDISCOVER_CHECK(graph.size() == 5);
+  ROSDISCOVER_CHECK(graph.getIndex(unused) == -1);
+  for (unsigned i = 0; i < graph.size(); ++i) {
+    ROSDISCOVER_CHECK(graph.getIndex(graph.getFunction(i)) == static_cast<int>(i));
+  }
+
+  // the callers of each function are grouped by callee, with duplicate edges kept
+  unsigned ia = graph.getIndex(a);
+  unsigned ib = graph.getIndex(b);
+  unsigned ic = graph.getIndex(c);
+  unsigned id = graph.getIndex(d);
+  unsigned ie = graph.getIndex(e);
+  ROSDISCOVER_CHECK(getCallers(graph, a) == sorted({ib, id, ib}));
+  ROSDISCOVER_CHECK(getCallers(graph, b) == sorted({ic}));
+  ROSDISCOVER_CHECK(getCallers(graph, c) == sorted({ib}));
+  ROSDISCOVER_CHECK(getCallers(graph, d) == sorted({ie}));
+  ROSDISCOVER_CHECK(getCallers(graph, e).empty());
+
+  ROSDISCOVER_CHECK(getSetBits(graph.findTransitiveCallers({a})) == sorted({ia, ib, ic, id, ie}));
+  ROSDISCOVER_CHECK(getSetBits(graph.findTransitiveCallers({c})) == sorted({ib, ic}));
+  ROSDISCOVER_CHECK(getSetBits(graph.findTransitiveCallers({e})) == sorted({ie}));
+  // functions that aren't part of the graph are ignored
+  ROSDISCOVER_CHECK(getSetBits(graph.findTransitiveCallers({d, unused})) == sorted({id, ie}));
+
+  std::vector<CompactCallGraph::Edge> noCalls;
+  CompactCallGraph empty(noCalls);
+  ROSDISCOVER_CHECK(empty.size() == 0);
+  ROSDISCOVER_CHECK(empty.getIndex(a) == -1);
+
+  return test::finish();
+}
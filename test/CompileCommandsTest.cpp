@@ -0,0 +1,60 @@
+#include <string>
+#include <vector>
+
+#include <clang/Tooling/CompilationDatabase.h>
+
+#include <rosdiscover-clang/Frontend/CompileCommands.h>
+
+#include "TestUtils.h"
+
+using namespace rosdiscover;
+
+namespace {
+
+clang::tooling::CompileCommand makeCommand(
+    std::string const &directory,
+    std::string const &filename,
+    std::string const &output
+) {
+  return clang::tooling::CompileCommand(directory, filename, {"c++", "-c", filename, "-o", output}, output);
+}
+
+void testPaths() {
+  auto command = makeCommand("/ws/build/pkg", "../../src/pkg/./node.cpp", "node.o");
+  ROSDISCOVER_CHECK(CompileCommandDeduplicator::getSourceFilePath(command) == "/ws/src/pkg/node.cpp");
+  ROSDISCOVER_CHECK(DependencyFile::getAbsolutePath(command.Directory, "node.o") == "/ws/build/pkg/node.o");
+  ROSDISCOVER_CHECK(DependencyFile::getAbsolutePath(command.Directory, "/tmp/../out/node.o") == "/out/node.o");
+}
+
+void testDeduplicate() {
+  // the first and last command compile the same file, from different build directories
+  std::vector<clang::tooling::CompileCommand> commands = {
+    makeCommand("/ws/build/a", "/ws/src/node.cpp", "a.o"),
+    makeCommand("/ws/build/b", "/ws/src/util.cpp", "util.o"),
+    makeCommand("/ws/build/c", "../../src/node.cpp", "c.o")
+  };
+
+  auto first = CompileCommandDeduplicator::deduplicate(commands, DuplicateCommandPolicy::KeepFirst);
+  ROSDISCOVER_CHECK(first.size() == 2);
+  if (first.size() == 2) {
+    ROSDISCOVER_CHECK(first[0].Output == "a.o");
+    ROSDISCOVER_CHECK(first[1].Output == "util.o");
+  }
+
+  auto last = CompileCommandDeduplicator::deduplicate(commands, DuplicateCommandPolicy::KeepLast);
+  ROSDISCOVER_CHECK(last.size() == 2);
+  if (last.size() == 2) {
+    ROSDISCOVER_CHECK(last[0].Output == "util.o");
+    ROSDISCOVER_CHECK(last[1].Output == "c.o");
+  }
+
+  ROSDISCOVER_CHECK(CompileCommandDeduplicator::deduplicate({}, DuplicateCommandPolicy::KeepFirst).empty());
+}
+
+} // namespace
+
+int main() {
+  testPaths();
+  testDeduplicate();
+  return test::finish();
+}
@@ -0,0 +1,79 @@
+#include <rosdiscover-clang/Helper/FileClassifier.h>
+
+#include "TestUtils.h"
+
+using namespace rosdiscover;
+
+namespace {
+
+void testPathPrefixTrie() {
+  PathPrefixTrie trie;
+  ROSDISCOVER_CHECK(!trie.matchesPrefixOf("/ws/src/node.cpp"));
+  ROSDISCOVER_CHECK(!trie.matchesPrefixOf(""));
+
+  trie.insert("/ws/src/pkg");
+  trie.insert("/opt/include");
+  ROSDISCOVER_CHECK(trie.matchesPrefixOf("/ws/src/pkg/node.cpp"));
+  ROSDISCOVER_CHECK(trie.matchesPrefixOf("/ws/src/pkg"));
+  // prefixes are matched character by character, not by path component
+  ROSDISCOVER_CHECK(trie.matchesPrefixOf("/ws/src/pkg2/node.cpp"));
+  ROSDISCOVER_CHECK(trie.matchesPrefixOf("/opt/include/header.h"));
+  ROSDISCOVER_CHECK(!trie.matchesPrefixOf("/ws/src/pk"));
+  ROSDISCOVER_CHECK(!trie.matchesPrefixOf("/ws/src/other/node.cpp"));
+  ROSDISCOVER_CHECK(!trie.matchesPrefixOf("/opt"));
+
+  PathPrefixTrie everything;
+  everything.insert("");
+  ROSDISCOVER_CHECK(everything.matchesPrefixOf("/any/path"));
+}
+
+void testClassifyByName() {
+  FileClassifier unrestricted;
+  ROSDISCOVER_CHECK(unrestricted.classify("/ws/src/node.cpp") == FileKind::Allowed);
+  ROSDISCOVER_CHECK(unrestricted.classify("/opt/ros/noetic/include/ros/node_handle.h") == FileKind::RosInternal);
+  ROSDISCOVER_CHECK(unrestricted.classify("/opt/ros/noetic/include/ros/param.h") == FileKind::RosInternal);
+  ROSDISCOVER_CHECK(unrestricted.classify("/opt/ros/noetic/include/ros/service.h") == FileKind::RosInternal);
+  ROSDISCOVER_CHECK(unrestricted.isAllowedPath("/usr/include/stdio.h"));
+
+  FileClassifier restricted({"/ws/src/a", "/ws/src/b"});
+  ROSDISCOVER_CHECK(restricted.classify("/ws/src/a/node.cpp") == FileKind::Allowed);
+  ROSDISCOVER_CHECK(restricted.classify("/ws/src/b/include/b/b.h") == FileKind::Allowed);
+  ROSDISCOVER_CHECK(restricted.classify("/ws/src/c/node.cpp") == FileKind::Ignored);
+  ROSDISCOVER_CHECK(restricted.classify("/opt/ros/noetic/include/ros/node_handle.h") == FileKind::RosInternal);
+  ROSDISCOVER_CHECK(restricted.isAllowedPath("/ws/src/a/node.cpp"));
+  ROSDISCOVER_CHECK(!restricted.isAllowedPath("/opt/ros/noetic/include/ros/node_handle.h"));
+}
+
+void testClassifyByLocation() {
+  auto ast = test::buildAST("int f() { return 0; }", "/ws/src/a/node.cpp");
+  ROSDISCOVER_CHECK(ast != nullptr);
+  if (ast == nullptr) {
+    return;
+  }
+  auto &context = ast->getASTContext();
+  auto const *function = test::findOnly<clang::FunctionDecl>(
+    context, clang::ast_matchers::functionDecl(clang::ast_matchers::hasName("f"))
+  );
+  ROSDISCOVER_CHECK(function != nullptr);
+  if (function == nullptr) {
+    return;
+  }
+
+  auto &sourceManager = context.getSourceManager();
+  FileClassifier allowed({"/ws/src/a"});
+  FileClassifier ignored({"/ws/src/b"});
+  ROSDISCOVER_CHECK(allowed.classify(sourceManager, function->getLocation()) == FileKind::Allowed);
+  ROSDISCOVER_CHECK(ignored.classify(sourceManager, function->getLocation()) == FileKind::Ignored);
+  // the classification of the file is cached
+  ROSDISCOVER_CHECK(ignored.classify(sourceManager, function->getBeginLoc()) == FileKind::Ignored);
+  ROSDISCOVER_CHECK(ignored.classify(sourceManager, clang::SourceLocation()) == FileKind::Allowed);
+}
+
+} // namespace
+
+int main() {
+  testPathPrefixTrie();
+  testClassifyByName();
+  testClassifyByLocation();
+  return test::finish();
+}
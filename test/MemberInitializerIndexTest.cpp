@@ -0,0 +1,83 @@
+#include <rosdiscover-clang/Helper/MemberInitializerIndex.h>
+
+#include "TestUtils.h"
+
+using namespace rosdiscover;
+using namespace clang::ast_matchers;
+
+namespace {
+
+char const *code = R"(
+  struct A {
+    int x = 1;
+    int y;
+    int z;
+
+    A() : y(2) {}
+    A(int v) : y(v), z(v) {}
+    A(A const &other) : x(other.x), y(other.y), z(other.z) {}
+    A(char const *name);
+  };
+
+  struct B {
+    int plain;
+  };
+)";
+
+clang::FieldDecl const * findField(clang::ASTContext &context, char const *name) {
+  return test::findOnly<clang::FieldDecl>(context, fieldDecl(hasName(name)));
+}
+
+bool isIntegerLiteral(clang::Expr const *expr, unsigned value) {
+  auto const *literal = clang::dyn_cast<clang::IntegerLiteral>(expr->IgnoreImpCasts());
+  return literal != nullptr && literal->getValue() == value;
+}
+
+bool refersTo(clang::Expr const *expr, char const *name) {
+  auto const *declRefExpr = clang::dyn_cast<clang::DeclRefExpr>(expr->IgnoreImpCasts());
+  return declRefExpr != nullptr && declRefExpr->getDecl()->getName() == name;
+}
+
+} // namespace
+
+int main() {
+  auto ast = test::buildAST(code);
+  ROSDISCOVER_CHECK(ast != nullptr);
+  if (ast == nullptr) {
+    return test::finish();
+  }
+  auto &context = ast->getASTContext();
+  auto const *x = findField(context, "x");
+  auto const *y = findField(context, "y");
+  auto const *z = findField(context, "z");
+  auto const *plain = findField(context, "plain");
+  ROSDISCOVER_CHECK(x && y && z && plain);
+  if (!(x && y && z && plain)) {
+    return test::finish();
+  }
+
+  MemberInitializerIndex index;
+
+  // constructors that don't initialize x explicitly use its in-class initializer
+  auto xInitializers = index.find(x);
+  ROSDISCOVER_CHECK(xInitializers.size() == 1);
+  ROSDISCOVER_CHECK(xInitializers.size() == 1 && xInitializers[0] == x->getInClassInitializer());
+  ROSDISCOVER_CHECK(xInitializers.size() == 1 && isIntegerLiteral(xInitializers[0], 1));
+
+  // the initializers of the copy constructor, and of constructors without a definition, are skipped
+  auto yInitializers = index.find(y);
+  ROSDISCOVER_CHECK(yInitializers.size() == 2);
+  ROSDISCOVER_CHECK(yInitializers.size() == 2 && isIntegerLiteral(yInitializers[0], 2));
+  ROSDISCOVER_CHECK(yInitializers.size() == 2 && refersTo(yInitializers[1], "v"));
+
+  auto zInitializers = index.find(z);
+  ROSDISCOVER_CHECK(zInitializers.size() == 1);
+  ROSDISCOVER_CHECK(zInitializers.size() == 1 && refersTo(zInitializers[0], "v"));
+
+  ROSDISCOVER_CHECK(index.find(plain).empty());
+
+  // each record is indexed once
+  ROSDISCOVER_CHECK(index.find(y).data() == yInitializers.data());
+
+  return test::finish();
+}
@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <unordered_map>
+#include <vector>
+
+#include <rosdiscover-clang/BackwardSymbolizer/ExprSymbolizer.h>
+#include <rosdiscover-clang/Cfg/FunctionCFGAnalysis.h>
+#include <rosdiscover-clang/Helper/ReachingDefinitions.h>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include "TestUtils.h"
+
+using namespace rosdiscover;
+using namespace clang::ast_matchers;
+
+namespace {
+
+char const *code = R"(
+  void s1();
+  void s2();
+  void s3();
+  void s4();
+  void s5();
+  void t1();
+  void t2();
+  void t3();
+
+  void nested(bool a, bool b, bool c) {
+    if (a) {
+      if (b) {
+        s1();
+      } else {
+        s2();
+      }
+    } else {
+      if (c) {
+        s3();
+      }
+      s4();
+    }
+    s5();
+  }
+
+  void loop(bool c, bool d) {
+    while (c) {
+      if (d) {
+        t1();
+        break;
+      }
+      t2();
+    }
+    t3();
+  }
+)";
+
+clang::CallExpr const * findCall(clang::ASTContext &context, char const *name) {
+  return test::findOnly<clang::CallExpr>(context, callExpr(callee(functionDecl(hasName(name)))));
+}
+
+/**
+ * Computes the path conditions of the calls to the given functions within a fresh analysis of a
+ * function, in the given order.
+ */
+std::vector<std::string> getPathConditions(
+    clang::ASTContext &context,
+    char const *functionName,
+    std::vector<char const *> const &callees
+) {
+  std::vector<std::string> conditions;
+  auto const *function = test::findOnly<clang::FunctionDecl>(
+    context,
+    functionDecl(hasName(functionName), isDefinition())
+  );
+  ROSDISCOVER_CHECK(function != nullptr);
+  if (function == nullptr) {
+    return conditions;
+  }
+
+  std::unordered_map<clang::Expr const *, SymbolicVariable *> apiCallToVar;
+  ReachingDefinitions reachingDefinitions(context);
+  ExprSymbolizer exprSymbolizer(context, apiCallToVar, reachingDefinitions);
+  FunctionCFGAnalysis analysis(function, context);
+  for (auto const *name : callees) {
+    auto const *call = findCall(context, name);
+    auto const *block = call == nullptr ? nullptr : analysis.getBlock(call);
+    ROSDISCOVER_CHECK(block != nullptr);
+    if (block == nullptr) {
+      conditions.push_back("");
+      continue;
+    }
+    auto *node = analysis.getControlDependenceGraph().getBlock(block);
+    conditions.push_back(node->getFullConditionExpr(context, exprSymbolizer)->toString());
+  }
+  return conditions;
+}
+
+/** Returns the given conditions in reverse order. */
+std::vector<std::string> reversed(std::vector<std::string> conditions) {
+  std::reverse(conditions.begin(), conditions.end());
+  return conditions;
+}
+
+/**
+ * Returns a function whose statements are reached under path conditions that share their
+ * subexpressions: every diamond in the chain may return early, and the call after it is reached
+ * along both of the paths that don't, which each include the path condition of the previous call.
+ */
+std::string makeDiamonds(unsigned depth) {
+  std::string declarations;
+  std::string parameters;
+  std::string body;
+  for (unsigned i = 0; i < depth; ++i) {
+    declarations += fmt::format("void u{}();\n", i);
+    parameters += fmt::format("{}bool a{}, bool b{}", i == 0 ? "" : ", ", i, i);
+    body += fmt::format("if (a{0}) {{ if (b{0}) {{ return; }} }}\nu{0}();\n", i);
+  }
+  return fmt::format("{}void diamonds({}) {{\n{}}}\n", declarations, parameters, body);
+}
+
+/** Returns the disjunction of two conditions, in either order. */
+std::pair<std::string, std::string> either(std::string const &lhs, std::string const &rhs) {
+  return {
+    fmt::format("({} || {})", lhs, rhs),
+    fmt::format("({} || {})", rhs, lhs)
+  };
+}
+
+bool isEither(std::string const &condition, std::pair<std::string, std::string> const &expected) {
+  return condition == expected.first || condition == expected.second;
+}
+
+/**
+ * Returns the size of the JSON of the path condition of the last call in a chain of diamonds of
+ * a given depth, and the number of shared subexpressions that it refers to.
+ */
+std::pair<size_t, size_t> getDiamondsJsonSize(unsigned depth) {
+  auto ast = test::buildAST(makeDiamonds(depth));
+  ROSDISCOVER_CHECK(ast != nullptr);
+  if (ast == nullptr) {
+    return {0, 0};
+  }
+  auto &context = ast->getASTContext();
+  auto const *function = test::findOnly<clang::FunctionDecl>(context, functionDecl(hasName("diamonds")));
+  auto const *call = findCall(context, fmt::format("u{}", depth - 1).c_str());
+  ROSDISCOVER_CHECK(function != nullptr && call != nullptr);
+  if (function == nullptr || call == nullptr) {
+    return {0, 0};
+  }
+
+  std::unordered_map<clang::Expr const *, SymbolicVariable *> apiCallToVar;
+  ReachingDefinitions reachingDefinitions(context);
+  ExprSymbolizer exprSymbolizer(context, apiCallToVar, reachingDefinitions);
+  FunctionCFGAnalysis analysis(function, context);
+  auto *node = analysis.getControlDependenceGraph().getBlock(analysis.getBlock(call));
+  auto condition = node->getFullConditionExpr(context, exprSymbolizer);
+
+  SharedExprTable sharedExprs;
+  auto json = sharedExprs.serialize(*condition);
+  auto jsonSharedExprs = sharedExprs.toJson();
+  return {json.dump().size() + jsonSharedExprs.dump().size(), jsonSharedExprs.size()};
+}
+
+void testDiamonds() {
+  auto ast = test::buildAST(makeDiamonds(2));
+  ROSDISCOVER_CHECK(ast != nullptr);
+  if (ast == nullptr) {
+    return;
+  }
+  auto &context = ast->getASTContext();
+
+  // the order of the disjuncts follows the order in which the dependencies are found
+  auto first = either("!(a0)", "(a0 && !(b0))");
+  auto second = either("((" + first.first + " && a1) && !(b1))", "(" + first.first + " && !(a1))");
+  auto secondSwapped = either("((" + first.second + " && a1) && !(b1))", "(" + first.second + " && !(a1))");
+  auto conditions = getPathConditions(context, "diamonds", {"u0", "u1"});
+  ROSDISCOVER_CHECK(conditions.size() == 2);
+  if (conditions.size() == 2) {
+    ROSDISCOVER_CHECK(isEither(conditions[0], first));
+    ROSDISCOVER_CHECK(
+      conditions[0] == first.first ? isEither(conditions[1], second) : isEither(conditions[1], secondSwapped)
+    );
+  }
+
+  // serialized with a table, the conditions grow linearly, even though they expand exponentially
+  auto shallow = getDiamondsJsonSize(8);
+  auto deep = getDiamondsJsonSize(16);
+  ROSDISCOVER_CHECK(shallow.second > 0);
+  ROSDISCOVER_CHECK(deep.second < 3 * shallow.second);
+  ROSDISCOVER_CHECK(deep.first < 3 * shallow.first);
+}
+
+/** Serializing an expression whose shared subexpressions are referenced once leaves them inline. */
+void testInline() {
+  auto shared = std::make_shared<BoolLiteral>(true);
+  AndExpr condition(std::make_unique<SharedExpr>(shared), std::make_unique<BoolLiteral>(false));
+  auto expected = condition.toJson();
+
+  SharedExprTable sharedExprs;
+  ROSDISCOVER_CHECK(sharedExprs.serialize(condition) == expected);
+  ROSDISCOVER_CHECK(sharedExprs.empty());
+}
+
+// the conditions that were computed by the original, per-statement construction of the graph
+void testNested(clang::ASTContext &context) {
+  std::vector<std::string> expected = {
+    "(a && b)",
+    "(a && !(b))",
+    "(!(a) && c)",
+    "!(a)",
+    "'true'"
+  };
+  auto conditions = getPathConditions(context, "nested", {"s1", "s2", "s3", "s4", "s5"});
+  ROSDISCOVER_CHECK(conditions == expected);
+
+  // the graph mustn't depend on which statements were queried first
+  auto backwards = getPathConditions(context, "nested", {"s5", "s4", "s3", "s2", "s1"});
+  ROSDISCOVER_CHECK(reversed(backwards) == expected);
+}
+
+void testLoop(clang::ASTContext &context) {
+  std::vector<std::string> expected = {
+    "(c && d)",
+    "(c && !(d))",
+    "'true'"
+  };
+  auto conditions = getPathConditions(context, "loop", {"t1", "t2", "t3"});
+  ROSDISCOVER_CHECK(conditions == expected);
+
+  auto backwards = getPathConditions(context, "loop", {"t3", "t2", "t1"});
+  ROSDISCOVER_CHECK(reversed(backwards) == expected);
+}
+
+} // namespace
+
+int main() {
+  auto ast = test::buildAST(code);
+  ROSDISCOVER_CHECK(ast != nullptr);
+  if (ast == nullptr) {
+    return test::finish();
+  }
+  auto &context = ast->getASTContext();
+  testNested(context);
+  testLoop(context);
+  testDiamonds();
+  testInline();
+  return test::finish();
+}
@@ -0,0 +1,119 @@
+#include <vector>
+
+#include <rosdiscover-clang/Helper/ReachingDefinitions.h>
+
+#include "TestUtils.h"
+
+using namespace rosdiscover;
+using namespace clang::ast_matchers;
+
+namespace {
+
+char const *code = R"(
+  struct S {
+    S();
+    S & operator=(int);
+  };
+
+  void f() {
+    int x = 1;
+    int y = x;
+    x = 2;
+    x += 3;
+    int z = x;
+    x = x + 4;
+    int w = x;
+
+    S s;
+    s = 5;
+    S t = s;
+  }
+
+  void g() {
+    int x = 7;
+    int u = x;
+  }
+)";
+
+clang::VarDecl const * findVar(clang::ASTContext &context, char const *name, char const *function) {
+  return test::findOnly<clang::VarDecl>(
+    context, varDecl(hasName(name), hasAncestor(functionDecl(hasName(function))))
+  );
+}
+
+clang::Expr const * findInit(clang::ASTContext &context, char const *name, char const *function) {
+  auto const *var = findVar(context, name, function);
+  return var == nullptr ? nullptr : var->getInit();
+}
+
+bool isSequence(std::vector<clang::Expr *> const &actual, std::vector<clang::Expr const *> const &expected) {
+  return std::vector<clang::Expr const *>(actual.begin(), actual.end()) == expected;
+}
+
+} // namespace
+
+int main() {
+  auto ast = test::buildAST(code);
+  ROSDISCOVER_CHECK(ast != nullptr);
+  if (ast == nullptr) {
+    return test::finish();
+  }
+  auto &context = ast->getASTContext();
+
+  auto const *x = findVar(context, "x", "f");
+  auto const *s = findVar(context, "s", "f");
+  auto const *xInG = findVar(context, "x", "g");
+  auto const *yInit = findInit(context, "y", "f");
+  auto const *zInit = findInit(context, "z", "f");
+  auto const *wInit = findInit(context, "w", "f");
+  auto const *tInit = findInit(context, "t", "f");
+  auto const *uInit = findInit(context, "u", "g");
+  auto const *assign = test::findOnly<clang::BinaryOperator>(
+    context, binaryOperator(hasOperatorName("="), hasRHS(integerLiteral(equals(2))))
+  );
+  auto const *compoundAssign = test::findOnly<clang::BinaryOperator>(context, binaryOperator(hasOperatorName("+=")));
+  auto const *selfAssign = test::findOnly<clang::BinaryOperator>(
+    context, binaryOperator(hasOperatorName("="), hasRHS(binaryOperator(hasOperatorName("+"))))
+  );
+  auto const *xInSelfAssign = test::findOnly<clang::DeclRefExpr>(
+    context, declRefExpr(to(varDecl(hasName("x"))), hasAncestor(binaryOperator(hasOperatorName("+"))))
+  );
+  auto const *operatorCall = test::findOnly<clang::CXXOperatorCallExpr>(
+    context, cxxOperatorCallExpr(hasOverloadedOperatorName("="))
+  );
+  bool found = x && s && xInG && yInit && zInit && wInit && tInit && uInit
+    && assign && compoundAssign && selfAssign && xInSelfAssign && operatorCall;
+  ROSDISCOVER_CHECK(found);
+  if (!found) {
+    return test::finish();
+  }
+
+  ReachingDefinitions reachingDefinitions(context);
+  ROSDISCOVER_CHECK(isSequence(reachingDefinitions.findAll(x, yInit), {x->getInit()}));
+  // the value of a compound assignment is the assignment itself
+  ROSDISCOVER_CHECK(isSequence(
+    reachingDefinitions.findAll(x, zInit),
+    {x->getInit(), assign->getRHS(), compoundAssign}
+  ));
+  // an assignment doesn't reach its own right-hand side
+  ROSDISCOVER_CHECK(isSequence(
+    reachingDefinitions.findAll(x, xInSelfAssign),
+    {x->getInit(), assign->getRHS(), compoundAssign}
+  ));
+  ROSDISCOVER_CHECK(isSequence(
+    reachingDefinitions.findAll(x, wInit),
+    {x->getInit(), assign->getRHS(), compoundAssign, selfAssign->getRHS()}
+  ));
+  ROSDISCOVER_CHECK(reachingDefinitions.find(x, wInit) == selfAssign->getRHS());
+  ROSDISCOVER_CHECK(reachingDefinitions.find(x, x->getInit()) == nullptr);
+
+  // a call to an overloaded assignment operator defines its first argument as its second
+  ROSDISCOVER_CHECK(isSequence(reachingDefinitions.findAll(s, tInit), {s->getInit(), operatorCall->getArg(1)}));
+
+  // definitions don't reach into other functions
+  ROSDISCOVER_CHECK(isSequence(reachingDefinitions.findAll(xInG, uInit), {xInG->getInit()}));
+  ROSDISCOVER_CHECK(reachingDefinitions.findAll(x, uInit).empty());
+  ROSDISCOVER_CHECK(reachingDefinitions.findAll(xInG, wInit).empty());
+
+  return test::finish();
+}
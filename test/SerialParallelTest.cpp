@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <rosdiscover-clang/BackwardSymbolizer/ProgramSymbolizer.h>
+
+#include "TestUtils.h"
+
+using namespace rosdiscover;
+
+namespace {
+
+// a stand-in for the ROS language bindings, whose API calls are found by their qualified names
+char const *code = R"(
+  namespace ros {
+  class NodeHandle {
+  public:
+    NodeHandle();
+    NodeHandle(char const *ns);
+    bool hasParam(char const *key) const;
+    bool getParam(char const *key, int &value) const;
+    void setParam(char const *key, int value) const;
+    bool deleteParam(char const *key) const;
+  };
+  }
+
+  void configure(ros::NodeHandle &nh, bool verbose) {
+    if (verbose) {
+      nh.setParam("verbose", 1);
+    } else {
+      nh.deleteParam("verbose");
+    }
+  }
+
+  int readRate(ros::NodeHandle &nh) {
+    int rate = 10;
+    if (nh.hasParam("rate")) {
+      nh.getParam("rate", rate);
+    }
+    return rate;
+  }
+
+  void setDepth(ros::NodeHandle &nh, int depth) {
+    if (depth > 0) {
+      nh.setParam("depth", depth);
+    }
+  }
+
+  // a default-constructed node handle
+  bool isSimulated() {
+    ros::NodeHandle nh;
+    return nh.hasParam("use_sim_time");
+  }
+
+  class Controller {
+  public:
+    Controller() : nh_("controller") {}
+    void start() { nh_.setParam("running", 1); }
+    void stop() { nh_.deleteParam("running"); }
+  private:
+    ros::NodeHandle nh_;
+  };
+
+  int main() {
+    ros::NodeHandle nh("~");
+    configure(nh, isSimulated());
+    int rate = readRate(nh);
+    while (rate > 0) {
+      setDepth(nh, rate);
+      rate = rate - 1;
+    }
+    Controller controller;
+    controller.start();
+    controller.stop();
+    return 0;
+  }
+)";
+
+/**
+ * Symbolizes the program, finding and symbolizing its API calls on a given number of threads,
+ * and returns the JSON of each of its functions in a canonical order.
+ */
+std::vector<std::string> symbolize(unsigned numJobs) {
+  std::vector<std::string> functions;
+  auto ast = test::buildAST(code);
+  ROSDISCOVER_CHECK(ast != nullptr);
+  if (ast == nullptr) {
+    return functions;
+  }
+
+  SymbolicProgram program;
+  std::vector<std::string> restrictAnalysisToPaths;
+  SymbolizerOptions options;
+  options.numMatchJobs = numJobs;
+  options.numSymbolizeJobs = numJobs;
+  Symbolizer::symbolize(ast->getASTContext(), program.getContext(), restrictAnalysisToPaths, options);
+
+  auto json = program.toJson();
+  for (auto const &function : json.at("program").at("functions")) {
+    functions.push_back(function.dump());
+  }
+  std::sort(functions.begin(), functions.end());
+  return functions;
+}
+
+} // namespace
+
+int main() {
+  auto serial = symbolize(1);
+  ROSDISCOVER_CHECK(!serial.empty());
+
+  // the output mustn't depend on the number of threads, or on how their work is interleaved
+  for (unsigned numJobs : {2, 4, 0, 4}) {
+    auto parallel = symbolize(numJobs);
+    ROSDISCOVER_CHECK(parallel == serial);
+  }
+
+  return test::finish();
+}
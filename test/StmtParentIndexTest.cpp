@@ -0,0 +1,84 @@
+#include <rosdiscover-clang/Helper/StmtParentIndex.h>
+
+#include "TestUtils.h"
+
+using namespace rosdiscover;
+using namespace clang::ast_matchers;
+
+namespace {
+
+char const *code = R"(
+  void f(int a, int b) {
+    if (a) {
+      while (b) {
+        b--;
+      }
+    } else {
+      a++;
+    }
+    int c = 0;
+  }
+
+  void g() {
+    int d = 1;
+  }
+)";
+
+} // namespace
+
+int main() {
+  auto ast = test::buildAST(code);
+  ROSDISCOVER_CHECK(ast != nullptr);
+  if (ast == nullptr) {
+    return test::finish();
+  }
+  auto &context = ast->getASTContext();
+  auto const *f = test::findOnly<clang::FunctionDecl>(context, functionDecl(hasName("f")));
+  auto const *g = test::findOnly<clang::FunctionDecl>(context, functionDecl(hasName("g")));
+  auto const *ifStatement = test::findOnly<clang::IfStmt>(context, ifStmt());
+  auto const *whileStatement = test::findOnly<clang::WhileStmt>(context, whileStmt());
+  auto const *decrement = test::findOnly<clang::UnaryOperator>(context, unaryOperator(hasOperatorName("--")));
+  auto const *increment = test::findOnly<clang::UnaryOperator>(context, unaryOperator(hasOperatorName("++")));
+  auto const *declC = test::findOnly<clang::DeclStmt>(context, declStmt(has(varDecl(hasName("c")))));
+  auto const *declD = test::findOnly<clang::DeclStmt>(context, declStmt(has(varDecl(hasName("d")))));
+  bool found = f && g && ifStatement && whileStatement && decrement && increment && declC && declD;
+  ROSDISCOVER_CHECK(found);
+  if (!found) {
+    return test::finish();
+  }
+
+  StmtParentIndex index(context);
+  ROSDISCOVER_CHECK(index.getFunction(decrement) == f);
+  ROSDISCOVER_CHECK(index.getFunction(ifStatement) == f);
+  ROSDISCOVER_CHECK(index.getFunction(declD) == g);
+  ROSDISCOVER_CHECK(index.getFunction(f->getBody()) == f);
+
+  ROSDISCOVER_CHECK(index.getControlFlowParent(decrement) == whileStatement);
+  ROSDISCOVER_CHECK(index.getControlFlowParent(whileStatement) == ifStatement);
+  ROSDISCOVER_CHECK(index.getControlFlowParent(increment) == ifStatement);
+  ROSDISCOVER_CHECK(index.getControlFlowParent(ifStatement->getCond()) == ifStatement);
+  ROSDISCOVER_CHECK(index.getControlFlowParent(declC) == nullptr);
+  ROSDISCOVER_CHECK(index.getControlFlowParent(declD) == nullptr);
+
+  // containment is strict, and follows the structure of the AST
+  ROSDISCOVER_CHECK(index.contains(ifStatement, decrement));
+  ROSDISCOVER_CHECK(index.contains(ifStatement, whileStatement));
+  ROSDISCOVER_CHECK(index.contains(ifStatement, increment));
+  ROSDISCOVER_CHECK(index.contains(whileStatement, decrement));
+  ROSDISCOVER_CHECK(index.contains(f->getBody(), declC));
+  ROSDISCOVER_CHECK(index.contains(ifStatement->getThen(), decrement));
+  ROSDISCOVER_CHECK(!index.contains(ifStatement->getThen(), increment));
+  ROSDISCOVER_CHECK(index.contains(ifStatement->getElse(), increment));
+  ROSDISCOVER_CHECK(!index.contains(whileStatement, increment));
+  ROSDISCOVER_CHECK(!index.contains(decrement, whileStatement));
+  ROSDISCOVER_CHECK(!index.contains(ifStatement, ifStatement));
+  ROSDISCOVER_CHECK(!index.contains(ifStatement, declC));
+  ROSDISCOVER_CHECK(!index.contains(ifStatement, nullptr));
+
+  // statements of different functions never contain each other
+  ROSDISCOVER_CHECK(!index.contains(f->getBody(), declD));
+  ROSDISCOVER_CHECK(!index.contains(g->getBody(), declC));
+  ROSDISCOVER_CHECK(index.contains(g->getBody(), declD));
+
+  return test::finish();
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <clang/AST/ASTContext.h>
+#include <clang/ASTMatchers/ASTMatchFinder.h>
+#include <clang/ASTMatchers/ASTMatchers.h>
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Tooling/Tooling.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace rosdiscover {
+namespace test {
+
+inline int & getNumFailures() {
+  static int numFailures = 0;
+  return numFailures;
+}
+
+inline void fail(char const *file, int line, char const *condition) {
+  llvm::errs() << file << ":" << line << ": check failed: " << condition << "\n";
+  ++getNumFailures();
+}
+
+/** Reports the number of failed checks, and returns the exit code of the test. */
+inline int finish() {
+  if (getNumFailures() == 0) {
+    return 0;
+  }
+  llvm::errs() << getNumFailures() << " check(s) failed\n";
+  return 1;
+}
+
+/**
+ * Parses a C++14 source file that is located at a given absolute path, along with the contents
+ * of any (absolute) headers that it includes.
+ */
+inline std::unique_ptr<clang::ASTUnit> buildAST(
+    std::string const &code,
+    std::string const &fileName = "/project/src/input.cc",
+    clang::tooling::FileContentMappings const &headers = {}
+) {
+  return clang::tooling::buildASTFromCodeWithArgs(
+    code,
+    {"-std=c++14"},
+    fileName,
+    "rosdiscover-test",
+    std::make_shared<clang::PCHContainerOperations>(),
+    clang::tooling::getClangStripDependencyFileAdjuster(),
+    headers
+  );
+}
+
+/** Returns all nodes that match a given matcher, in traversal order. */
+template <typename NodeType, typename MatcherType>
+std::vector<NodeType const *> findAll(clang::ASTContext &context, MatcherType const &matcher) {
+  std::vector<NodeType const *> nodes;
+  for (auto const &match : clang::ast_matchers::match(matcher.bind("node"), context)) {
+    nodes.push_back(match.template getNodeAs<NodeType>("node"));
+  }
+  return nodes;
+}
+
+/** Returns the only node that matches a given matcher, or nullptr if there isn't exactly one. */
+template <typename NodeType, typename MatcherType>
+NodeType const * findOnly(clang::ASTContext &context, MatcherType const &matcher) {
+  auto nodes = findAll<NodeType>(context, matcher);
+  return nodes.size() == 1 ? nodes.front() : nullptr;
+}
+
+} // rosdiscover::test
+} // rosdiscover
+
+#define ROSDISCOVER_CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      rosdiscover::test::fail(__FILE__, __LINE__, #condition); \
+    } \
+  } while (false)